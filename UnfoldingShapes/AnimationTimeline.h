@@ -0,0 +1,154 @@
+#ifndef ANIMATIONTIMELINE_H
+#define ANIMATIONTIMELINE_H
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+#include "Face.h"
+#include "Graph.h"
+#include "Shape.h"
+#include "Unfold.h"
+
+using namespace std;
+
+// An unfold animation baked into evenly spaced samples of every face's transform.
+// Posing a frame then only blends the two keys around the progress of each face, so it costs the same for any tree depth
+// and jumping to any point of the animation (scrubbing) is as cheap as playing it.
+// Each key is stored as a rotation and the posed position of the face's centroid, so a face turns about its own center between two keys and stays rigid.
+class AnimationTimeline {
+public:
+	// enough keys for the blend between two of them to stay close to the exact pose of a continuous unfold
+	static const int defaultSamples = 64;
+
+	// most keys a timeline keeps (about 56 MB), larger models get fewer samples
+	static const int maxKeys = 1 << 21;
+
+	// number of samples to bake the animation of the shape's unfold with (0 if it should be posed live instead)
+	// the step based animation is never baked: between two keys a blend moves every face in a straight line, so a subtree swinging
+	// about one hinge would cut across its arc (even with a key on every step boundary), and the live step schedule is a single pass anyway
+	static int samplesFor(Shape* shape, int algorithm, int samples) {
+		if (algorithm == 0) {
+			return 0;
+		}
+
+		int faces = std::max((int)shape->adjacency.size(), 1);
+
+		return std::min(std::max(samples, 2), std::max(maxKeys / faces, 2));
+	}
+
+	AnimationTimeline() {
+		sampleCount = 0;
+		faceCount = 0;
+		revision = 0;
+		algorithm = -1;
+	}
+
+	// sample the animation of the shape's current unfold (samples is clamped to at least 2, the first at 0 and the last at 1)
+	// see samplesFor for a count that suits the algorithm
+	void bake(Shape* shape, int algorithm, int samples) {
+		clear();
+
+		if (shape->unfold == nullptr) {
+			return;
+		}
+
+		this->revision = shape->unfoldRevision;
+		this->algorithm = algorithm;
+
+		sampleCount = std::max(samples, 2);
+		faceCount = shape->adjacency.size();
+		centroids = shape->adjacency.centroids;
+
+		keys.resize(sampleCount * faceCount);
+
+		for (int i = 0; i < sampleCount; i++) {
+			vector<glm::mat4> transforms = Unfold::transforms(shape, shape->unfold, algorithm, (float)i / (sampleCount - 1));
+
+			for (int j = 0; j < faceCount; j++) {
+				Key &key = keys[i * faceCount + j];
+
+				key.rotation = glm::quat_cast(glm::mat3(transforms[j]));
+				key.center = glm::vec3(transforms[j] * glm::vec4(centroids[j], 1.0f));
+			}
+		}
+	}
+
+	void clear() {
+		keys.clear();
+		centroids.clear();
+		sampleCount = 0;
+		faceCount = 0;
+		revision = 0;
+		algorithm = -1;
+	}
+
+	bool isBaked() const {
+		return !keys.empty();
+	}
+
+	// true if the keys still belong to the shape's unfold with the given settings
+	bool isBakedFor(Shape* shape, int algorithm, int samples) const {
+		return isBaked() && revision == shape->unfoldRevision && this->algorithm == algorithm
+			&& sampleCount == std::max(samples, 2) && faceCount == shape->adjacency.size();
+	}
+
+	int getSampleCount() const {
+		return sampleCount;
+	}
+
+	// transform of every face at any progress (0.0-1.0) from the two keys around it
+	void evaluate(float progress, vector<glm::mat4> &transforms) const {
+		transforms.resize(faceCount);
+
+		float position = std::min(std::max(progress, 0.0f), 1.0f) * (sampleCount - 1);
+		int first = std::min((int)floor(position), sampleCount - 2);
+		float t = position - first;
+
+		const Key* from = &keys[first * faceCount];
+		const Key* to = &keys[(first + 1) * faceCount];
+
+		for (int i = 0; i < faceCount; i++) {
+			glm::quat rotation = glm::slerp(from[i].rotation, to[i].rotation, t);
+			glm::vec3 center = glm::mix(from[i].center, to[i].center, t);
+
+			// rotate about the rest centroid and move it to the blended center
+			glm::mat4 transform = glm::mat4_cast(rotation);
+			transform[3] = glm::vec4(center - glm::mat3(transform) * centroids[i], 1.0f);
+
+			transforms[i] = transform;
+		}
+	}
+
+	vector<glm::mat4> evaluate(float progress) const {
+		vector<glm::mat4> transforms;
+		evaluate(progress, transforms);
+
+		return transforms;
+	}
+
+private:
+	struct Key {
+		glm::quat rotation;
+		glm::vec3 center;
+	};
+
+	// sample after sample, one key per face
+	vector<Key> keys;
+
+	// rest centroid of every face (the point each face turns about between keys)
+	vector<glm::vec3> centroids;
+
+	int sampleCount;
+	int faceCount;
+
+	// what the keys were baked from (see Shape::unfoldRevision)
+	unsigned int revision;
+	int algorithm;
+};
+
+#endif
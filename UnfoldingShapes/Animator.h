@@ -8,6 +8,9 @@
 
 #include <iostream>
 #include <vector>
+#include <algorithm>
+#include <chrono>
+#include <memory>
 
 // graphics tools
 #include "Camera.h"
@@ -19,6 +22,8 @@
 #include "Face.h"
 #include "Graph.h"
 #include "Unfold.h"
+#include "AnimationTimeline.h"
+#include "PosePipeline.h"
 
 class Animator {
 public:
@@ -31,15 +36,36 @@ public:
 		// which of the available algortihms is being used
 		int activeAlgorithm;
 
-		// milliseconds for animation to complete
-		float speed;
+		// seconds for the animation to complete
+		float duration;
 
+		// progress at the time of the last update, playback moves on from there by the wall clock time that passed
 		float progress;
+		std::chrono::steady_clock::time_point lastUpdate;
 
-		Animation(Shape* shape, bool paused = false, int algorithm = 1, float speed = 1) {
+		// number of keys to bake the continuous animation into (0 computes every frame from the unfold tree instead)
+		// only the continuous animation is baked, and large models get fewer keys (see AnimationTimeline::samplesFor)
+		int bakeSamples;
+
+		// cached keys of the current unfold when baking is on (rebaked on demand when the unfold or algorithm changes)
+		// a rebake makes a new timeline so a pose evaluated on the pose worker can keep using the old one
+		std::shared_ptr<const AnimationTimeline> timeline;
+
+		// milliseconds spent evaluating a pose of this animation (averaged over the last frames)
+		float poseCost;
+
+		// counts every jump in playback (play, pause, stop, scrub or a change of algorithm or duration)
+		// a frame the pose worker evaluated before the last jump is not shown
+		unsigned int sequence;
+
+		Animation(Shape* shape, bool paused = false, int algorithm = 1, float duration = 12.5f) {
 			this->shape = shape;
-			this->speed = speed;
+			this->duration = duration;
 			progress = 0.0f;
+			lastUpdate = std::chrono::steady_clock::now();
+			bakeSamples = 0;
+			poseCost = 0.0f;
+			sequence = 0;
 
 			this->activeAlgorithm = algorithm;
 			this->paused = paused;
@@ -51,87 +77,237 @@ public:
 
 		void pause() {
 			paused = true;
+			sequence++;
 		}
 
+		// the time spent paused is not played back
 		void play() {
 			paused = false;
+			lastUpdate = std::chrono::steady_clock::now();
+			sequence++;
 		}
 
 		void stop() {
 			paused = true;
 			progress = 0;
+			sequence++;
 		}
 
 		// input a decimal 0.0-1.0 to represet percentage
+		// the shape is posed right away so scrubbing also works while paused
 		void scrub(float delta) {
-			progress += delta;
+			progress = std::min(std::max(progress + delta, 0.0f), 1.0f);
+			sequence++;
+
+			pose();
+		}
+
+		// progress the animation has (or will have) at any point in time if it keeps playing, not limited to 0.0-1.0
+		float progressAt(std::chrono::steady_clock::time_point time) const {
+			if (paused) {
+				return progress;
+			}
+
+			return progress + std::chrono::duration<float>(time - lastUpdate).count() / std::max(duration, 0.001f);
+		}
+
+		// move the progress on to the given time, a late frame skips ahead instead of slowing the animation down
+		void advance(std::chrono::steady_clock::time_point time) {
+			progress = progressAt(time);
+			lastUpdate = time;
+		}
+
+		// pose the shape as it is at the given time (without moving the animation on)
+		void poseAt(std::chrono::steady_clock::time_point time) {
+			pose(std::min(std::max(progressAt(time), 0.0f), 1.0f));
+		}
+
+		// pose the shape at the current progress (from the baked keys if baking is on)
+		void pose() {
+			pose(progress);
+		}
+
+		void pose(float progress) {
+			if (shape->unfold == nullptr) {
+				return;
+			}
+
+			vector<glm::mat4> transforms;
+			job(progress)(transforms);
+
+			shape->setPose(transforms);
 		}
 
-		void incrementSpeed(float delta) {
-			speed += delta;
+		// what a frame evaluated now is for, a frame is only shown while this stays the same
+		PosePipeline::Tag frameTag() const {
+			return ((PosePipeline::Tag)shape->unfoldRevision << 32) | sequence;
+		}
+
+		void recordCost(float milliseconds) {
+			poseCost = poseCost == 0.0f ? milliseconds : poseCost * 0.9f + milliseconds * 0.1f;
+		}
+
+		// evaluation of the pose at a progress that only holds on to data nothing changes afterwards, so it can run on any thread
+		PosePipeline::Job job(float progress) {
+			progress = std::min(std::max(progress, 0.0f), 1.0f);
+
+			int samples = bakeSamples > 0 ? AnimationTimeline::samplesFor(shape, activeAlgorithm, bakeSamples) : 0;
+
+			if (samples > 0) {
+				if (timeline == nullptr || !timeline->isBakedFor(shape, activeAlgorithm, samples)) {
+					std::shared_ptr<AnimationTimeline> baked = std::make_shared<AnimationTimeline>();
+					baked->bake(shape, activeAlgorithm, samples);
+
+					timeline = baked;
+				}
+
+				std::shared_ptr<const AnimationTimeline> keys = timeline;
+				return [keys, progress](vector<glm::mat4> &transforms) {
+					keys->evaluate(progress, transforms);
+				};
+			}
+
+			timeline = nullptr;
+
+			std::shared_ptr<const UnfoldSchedule> schedule = shape->unfoldSchedule;
+			int algorithm = activeAlgorithm;
+
+			return [schedule, algorithm, progress](vector<glm::mat4> &transforms) {
+				schedule->transforms(algorithm, progress, transforms);
+			};
+		}
+
+		void incrementDuration(float delta) {
+			duration = std::max(duration + delta, 0.0f);
+			sequence++;
 		}
 
 		void shuffleAlgorithm() {
 			int algorithmCount = 2;
 
 			activeAlgorithm = (activeAlgorithm + 1) % algorithmCount;
+			sequence++;
 		}
 
 		void setAlgorithm(int n) {
 			activeAlgorithm = n;
+			sequence++;
 		}
 	};
 
 	Animator() {
 		animations = new vector<Animation>();
+
+		pipelined = true;
+		poses = nullptr;
+		lastFrame = std::chrono::steady_clock::now();
 	}
 
+	// evaluate the pose of the next frame on a worker thread while the current one is drawn (one frame behind, see PosePipeline)
+	bool pipelined;
+
 	// main update function for all animations
 	void update() {
+		update(std::chrono::steady_clock::now());
+	}
+
+	// progress is driven by the time that passed since the last update, so playback speed does not depend on the frame rate
+	// the poses of every playing animation are evaluated together (one batch spread over the cores) instead of one animation after the other
+	void update(std::chrono::steady_clock::time_point now) {
+		// the next update is expected as far ahead as the last one was behind
+		std::chrono::steady_clock::time_point nextFrame = now + (now - lastFrame);
+		lastFrame = now;
+
+		if (pipelined && poses == nullptr) {
+			poses = new PosePipeline();
+		}
+
+		// animations that have to be posed before this update returns, and the frames the worker should have ready for the next one
+		vector<int> direct;
+		vector<PosePipeline::Request> next;
+
 		for (int i = 0; i < animations->size(); i++) {
-			if ((*animations)[i].shape->unfold != nullptr && !(*animations)[i].paused) {
-				if ((*animations)[i].progress < 0.0f) {
-					// revert the shape to default position since we round up to 0 from negative progress
-					(*animations)[i].shape->revert();
+			Animation &animation = (*animations)[i];
 
-					(*animations)[i].progress = 0.0f;
+			if (animation.shape->unfold == nullptr || animation.paused) {
+				if (poses != nullptr) {
+					poses->cancel(i);
 				}
-				else if ((*animations)[i].progress < 1.0f) {
-					// identify which algorithm to use
-					switch ((*animations)[i].activeAlgorithm) {
-					case 0: {
-						Unfold::stepBasedUpdate((*animations)[i].shape, (*animations)[i].shape->unfold, (*animations)[i].progress);
-						break;
-					}
-					case 1: {
-						Unfold::breadthFirstUpdate((*animations)[i].shape, (*animations)[i].shape->unfold, (*animations)[i].progress);
-						break;
-					}
-					}
-
-					//if (!(*animations)[i].paused) {
-					//std::cout << (*animations)[i].progress << std::endl;
-					(*animations)[i].progress += (*animations)[i].speed / (100 * 7.5f);
-					//}
+
+				continue;
+			}
+
+			if (animation.progress < 0.0f) {
+				// revert the shape to default position since we round up to 0 from negative progress
+				animation.shape->revert();
+
+				animation.progress = 0.0f;
+				animation.lastUpdate = now;
+			}
+			else if (animation.progress < 1.0f) {
+				animation.advance(now);
+
+				// the last frame lands exactly on the finished pose
+				animation.progress = std::min(animation.progress, 1.0f);
+
+				if (!pipelined || animation.progress >= 1.0f) {
+					direct.push_back(i);
+					continue;
 				}
-				else if ((*animations)[i].progress > 1.0f) {
-					(*animations)[i].progress = 1.0f;
 
-					Unfold::breadthFirstUpdate((*animations)[i].shape, (*animations)[i].shape->unfold, (*animations)[i].progress);
+				// show the frame the worker evaluated for this update, unless it is missing or the unfold or playback changed since it was requested
+				PosePipeline::Tag tag;
+				float cost;
+				if (poses->take(i, frame, tag, cost) && tag == animation.frameTag() && frame.size() == animation.shape->adjacency.size()) {
+					animation.shape->setPose(frame);
+					animation.recordCost(cost);
 				}
+				else {
+					direct.push_back(i);
+				}
+
+				next.push_back(PosePipeline::Request(i, animation.job(animation.progressAt(nextFrame)), animation.frameTag()));
+			}
+		}
+
+		poseNow(direct);
+
+		if (!next.empty()) {
+			poses->request(next);
+		}
+	}
+
+	// milliseconds all playing animations spend on evaluating their poses per frame
+	float poseCost() {
+		float total = 0.0f;
+
+		for (int i = 0; i < animations->size(); i++) {
+			if (!(*animations)[i].paused) {
+				total += (*animations)[i].poseCost;
+			}
+		}
+
+		return total;
+	}
 
-				// rebuild the mesh for each shape
-				(*animations)[i].shape->model->rebuildMeshes();
+	int playingCount() {
+		int count = 0;
+
+		for (int i = 0; i < animations->size(); i++) {
+			if (!(*animations)[i].paused && (*animations)[i].shape->unfold != nullptr) {
+				count++;
 			}
 		}
+
+		return count;
 	}
 
 	// check if the animation for the shape already exists and if not then create it
-	void addAnimation(Shape* shape, bool paused = false, int algorithm = 1, float speed = 1) {
+	void addAnimation(Shape* shape, bool paused = false, int algorithm = 1, float duration = 12.5f) {
 		bool found = false;
 
 		if (!found) {
-			animations->push_back(Animation(shape, paused, algorithm, speed));
+			animations->push_back(Animation(shape, paused, algorithm, duration));
 		}
 	}
 
@@ -146,6 +322,38 @@ public:
 
 private:
 	vector<Animation>* animations;
+
+	// pose the animations at their current progress in one batch
+	void poseNow(const vector<int> &indices) {
+		if (indices.empty()) {
+			return;
+		}
+
+		vector<PosePipeline::Job> jobs;
+		vector<vector<glm::mat4>> frames(indices.size());
+		vector<vector<glm::mat4>*> outputs;
+		vector<float> costs;
+
+		for (int i = 0; i < indices.size(); i++) {
+			jobs.push_back((*animations)[indices[i]].job((*animations)[indices[i]].progress));
+			outputs.push_back(&frames[i]);
+		}
+
+		PosePipeline::runBatch(jobs, outputs, costs);
+
+		for (int i = 0; i < indices.size(); i++) {
+			(*animations)[indices[i]].shape->setPose(frames[i]);
+			(*animations)[indices[i]].recordCost(costs[i]);
+		}
+	}
+
+	// created on the first update so only the animator that is used starts a thread
+	PosePipeline* poses;
+
+	// buffer the finished frames are swapped into
+	vector<glm::mat4> frame;
+
+	std::chrono::steady_clock::time_point lastFrame;
 };
 
 #endif
\ No newline at end of file
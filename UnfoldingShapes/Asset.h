@@ -100,6 +100,18 @@ public:
 	void setScale(glm::vec3 scale) {
 		this->scale = scale;
 	}
+
+	// model matrix used to draw the asset (position, then rotation about x, y and z, then scale)
+	glm::mat4 getModelMatrix() {
+		glm::mat4 model = glm::mat4(1.0f);
+		model = glm::translate(model, position);
+		model = glm::rotate(model, glm::radians(rotation.x), glm::vec3(1.0, 0.0, 0.0));
+		model = glm::rotate(model, glm::radians(rotation.y), glm::vec3(0.0, 1.0, 0.0));
+		model = glm::rotate(model, glm::radians(rotation.z), glm::vec3(0.0, 0.0, 1.0));
+		model = glm::scale(model, scale);
+
+		return model;
+	}
 };
 
 #endif
\ No newline at end of file
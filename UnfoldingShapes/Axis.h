@@ -11,14 +11,16 @@
 #include <string>
 #include <vector>
 #include <cmath>
+#include <algorithm>
 
 #include "Mesh.h"
+#include "Predicates.h"
 
 // Codependency fix with Face class was to make this generic
 template<class T>
 class Axis {
 private:
-	// smallest possible float
+	// distance two edges may be apart and still match, relative to the length of the edges
 	const float marginOfError = 0.0001;
 	const float sizeCap = 1000.0f;
 
@@ -44,6 +46,8 @@ public:
 	}
 
 	Axis(glm::vec3 p1, glm::vec3 p2) {
+		defaultSetup();
+
 		this->p1 = p1;
 		this->p2 = p2;
 
@@ -65,6 +69,9 @@ public:
 		point = originalPoint;
 		line = originalLine;
 		originalAngle = 0.0f;
+
+		p1 = glm::vec3(0);
+		p2 = glm::vec3(0);
 	}
 
 	void revert() {
@@ -72,6 +79,17 @@ public:
 		point = originalPoint;
 	}
 
+	// apply a rigid transform to the rest state of the axis (used when the whole shape is re-oriented)
+	void transformRest(glm::mat4 transform) {
+		p1 = glm::vec3(transform * glm::vec4(p1, 1.0f));
+		p2 = glm::vec3(transform * glm::vec4(p2, 1.0f));
+
+		originalLine = glm::normalize(glm::vec3(transform * glm::vec4(originalLine, 0.0f)));
+		originalPoint = closestPointOnLine(originalLine, glm::vec3(transform * glm::vec4(originalPoint, 1.0f)), glm::vec3(0));
+
+		revert();
+	}
+
 	void setNeighbor(T* neighbor, Axis* axis) {
 		sharedAxis = axis;
 		neighborFace = neighbor;
@@ -86,36 +104,6 @@ public:
 		return glm::vec3(rotationMat * glm::vec4(p - point, 1.0f)) + point;
 	}
 
-	// transform this axis based on another axis
-	void rotateAxisAbout(Axis* axis, float angle) {
-		//std::cout << "1 " << glm::to_string(line) << " " << glm::to_string(point) << std::endl;
-		glm::vec3 point1 = line * -0.1f + point;
-		glm::vec3 point2 = line * 0.1f + point;
-
-		point1 = axis->rotateAbout(point1, angle);
-		point2 = axis->rotateAbout(point2, angle);
-
-		// normalize to standardize it
-		line = glm::normalize(point2 - point1);
-
-		//point = closestPointOnLine(line, point1, glm::vec3(0));
-		point = axis->rotateAbout(point, angle);
-
-		//std::cout << "2 " << glm::to_string(line) << " " << glm::to_string(point) << std::endl;
-	}
-
-	float orientedAngle(glm::vec3 p1, glm::vec3 p2) {
-		p1 = glm::normalize(p1 - point);
-		p2 = glm::normalize(p2 - point);
-
-		float result = glm::orientedAngle(p1, p2, line);
-		result = (result / (sqrt(result*result)))*3.1415926535 - result;
-
-		// std::cout << "result: " << result << std::endl;
-
-		return result;
-	}
-
 	// check if the axis contains a point
 	bool hasPoint(glm::vec3 p) {
 		//std::cout << glm::to_string(line) << " " << glm::to_string(point) << std::endl;
@@ -124,15 +112,20 @@ public:
 
 		//std::cout << glm::to_string(pointOnLine) << " " << glm::to_string(p) << " " << glm::to_string(line) << std::endl;
 
-		if (glm::distance(pointOnLine, p) <= marginOfError) {
+		if (glm::distance(pointOnLine, p) <= marginOfError * glm::distance(p1, p2)) {
 			return true;
 		}
 
 		return false;
 	}
 
+	// both edges lie on the same line (compared on the rest edges, which is where faces and neighbors are matched)
+	// the ends of one edge are tested against the line of the other with exact predicates, so edges that share their vertices always match
 	bool operator==(Axis a) {
-		if (hasPoint(a.point) && glm::distance(point, a.point) < marginOfError)
+		double distance = marginOfError * std::max(glm::distance(p1, p2), glm::distance(a.p1, a.p2));
+
+		if (Predicates::collinear(p1, p2, a.p1, distance) && Predicates::collinear(p1, p2, a.p2, distance) &&
+			Predicates::collinear(a.p1, a.p2, p1, distance) && Predicates::collinear(a.p1, a.p2, p2, distance))
 		{
 			return true;
 		}
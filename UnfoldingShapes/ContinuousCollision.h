@@ -0,0 +1,349 @@
+#ifndef CONTINUOUSCOLLISION_H
+#define CONTINUOUSCOLLISION_H
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <cfloat>
+#include <utility>
+#include <cmath>
+#include <atomic>
+
+#include "FaceAdjacency.h"
+#include "NetValidation.h"
+#include "TriangleBVH.h"
+#include "GeometryKernels.h"
+
+// Checks the continuous fold animation (every hinge at angle * progress, like Unfold::breadthFirstUpdate) for faces passing through each other.
+// This is a sampled check, not continuous collision detection: the faces are tested at evenly spaced points of the animation.
+// The number of samples comes from a bound on how fast any corner can move (the hinge angles times how far each face can be from the hinges above it),
+// so no corner moves further than half the thinnest triangle between two samples; a crossing shallower than that can still fall between them.
+// The triangle BVH is refitted at every sample and rebuilt every rebuildInterval of progress so its boxes stay tight as the net opens up,
+// and the first sample with a collision is narrowed down by bisection.
+// Faces that share an edge in the shape are never tested against each other since they always meet along that edge.
+static class ContinuousCollision {
+public:
+	// rebuild the hierarchy after this much progress (refitting alone lets the boxes grow loose as the faces move apart)
+	static constexpr float rebuildInterval = 0.125f;
+
+	struct Result {
+		bool collides;
+
+		// first progress (0.0-1.0) at which two faces intersect
+		float progress;
+
+		int faceA;
+		int faceB;
+
+		// number of samples taken, and false if maxSteps was too low to keep every step within the motion bound
+		int steps;
+		bool bounded;
+
+		Result() {
+			collides = false;
+			progress = 1.0f;
+			faceA = -1;
+			faceB = -1;
+			steps = 0;
+			bounded = true;
+		}
+	};
+
+	// the number of samples is picked from the motion bound, between minSteps and maxSteps
+	// cancelled can be set from another thread to stop early (the result then reports no collision)
+	static Result firstCollision(const FaceAdjacency &adjacency, const UnfoldTree &tree, int minSteps = 64, int maxSteps = 4096, int refinements = 8, const std::atomic<bool>* cancelled = nullptr) {
+		Result result;
+
+		if (tree.root == -1 || adjacency.size() == 0) {
+			return result;
+		}
+
+		float needed = std::ceil(maxSpeed(adjacency, tree) / stepDistance(adjacency));
+
+		result.bounded = needed <= maxSteps;
+		result.steps = (int)std::min(std::max(needed, (float)minSteps), (float)maxSteps);
+
+		Sweep sweep(adjacency, tree);
+
+		float clear = 0.0f;
+		for (int i = 0; i <= result.steps; i++) {
+			if (cancelled != nullptr && *cancelled) {
+				return Result();
+			}
+
+			float progress = (float)i / result.steps;
+
+			if (sweep.findCollision(progress, result.faceA, result.faceB)) {
+				result.collides = true;
+				result.progress = progress;
+				break;
+			}
+
+			clear = progress;
+		}
+
+		if (!result.collides) {
+			return result;
+		}
+
+		// the collision starts somewhere between the last clear step and the colliding one
+		for (int i = 0; i < refinements && result.progress > 0.0f; i++) {
+			float middle = (clear + result.progress) * 0.5f;
+
+			int faceA, faceB;
+			if (sweep.findCollision(middle, faceA, faceB)) {
+				result.progress = middle;
+				result.faceA = faceA;
+				result.faceB = faceB;
+			}
+			else {
+				clear = middle;
+			}
+		}
+
+		return result;
+	}
+
+	// true if the two triangles cross each other by more than the margin (touching along an edge or at a corner does not count)
+	// based on the interval overlap test by Moller, with coplanar triangles handed to the 2D test
+	static bool trianglesIntersect(const glm::vec3* a, const glm::vec3* b, float margin) {
+		glm::vec3 normalA = glm::cross(a[1] - a[0], a[2] - a[0]);
+		glm::vec3 normalB = glm::cross(b[1] - b[0], b[2] - b[0]);
+
+		if (glm::length(normalA) <= 0.0f || glm::length(normalB) <= 0.0f) {
+			return false;
+		}
+		normalA = glm::normalize(normalA);
+		normalB = glm::normalize(normalB);
+
+		// distance of each corner to the plane of the other triangle (snapped to zero inside the margin)
+		float distanceB[3], distanceA[3];
+		for (int i = 0; i < 3; i++) {
+			distanceB[i] = snap(glm::dot(normalA, b[i] - a[0]), margin);
+			distanceA[i] = snap(glm::dot(normalB, a[i] - b[0]), margin);
+		}
+
+		if (sameSide(distanceB) || sameSide(distanceA)) {
+			return false;
+		}
+
+		// both triangles lie in the same plane
+		if (distanceB[0] == 0 && distanceB[1] == 0 && distanceB[2] == 0) {
+			return coplanarOverlap(a, b, normalA, margin);
+		}
+
+		// both triangles cross the line where the planes meet, compare the parts of the line they cover
+		glm::vec3 direction = glm::cross(normalA, normalB);
+		if (glm::length(direction) <= 0.0f) {
+			return false;
+		}
+		direction = glm::normalize(direction);
+
+		float minA, maxA, minB, maxB;
+		if (!lineInterval(a, distanceA, direction, minA, maxA) || !lineInterval(b, distanceB, direction, minB, maxB)) {
+			return false;
+		}
+
+		return std::min(maxA, maxB) - std::max(minA, minB) > margin;
+	}
+
+	// upper bound on how far any corner moves per unit of progress
+	// a face turns with every hinge above it, and each hinge moves it at (angle * distance to the hinge), where the distance
+	// is at most the sum of the face sizes along the tree from the hinge down to it (the faces in between share edges)
+	static float maxSpeed(const FaceAdjacency &adjacency, const UnfoldTree &tree) {
+		// summed hinge angles from the root down to each face, and the speed bound of each face
+		vector<float> turn(adjacency.size(), 0.0f);
+		vector<float> speed(adjacency.size(), 0.0f);
+
+		float fastest = 0.0f;
+
+		vector<int> order = tree.order();
+		for (int i = 1; i < order.size(); i++) {
+			int face = order[i];
+			int parent = tree.parent[face];
+
+			turn[face] = turn[parent] + std::abs(adjacency.edges[parent][tree.parentEdge[face]].angle);
+			speed[face] = speed[parent] + turn[face] * faceSize(adjacency, face);
+
+			fastest = std::max(fastest, speed[face]);
+		}
+
+		return fastest;
+	}
+
+	// half the smallest height of any triangle (but no less than the overlap margin)
+	static float stepDistance(const FaceAdjacency &adjacency) {
+		float margin = glm::length(adjacency.restMax - adjacency.restMin) * 0.0001f;
+		float thinnest = FLT_MAX;
+
+		for (int i = 0; i < adjacency.size(); i++) {
+			const vector<glm::vec3> &positions = adjacency.restPositions[i];
+			const vector<unsigned int> &indices = adjacency.indices[i];
+
+			for (int j = 0; j + 2 < indices.size(); j += 3) {
+				glm::vec3 a = positions[indices[j]], b = positions[indices[j + 1]], c = positions[indices[j + 2]];
+
+				float longest = std::max(glm::length(b - a), std::max(glm::length(c - b), glm::length(a - c)));
+				float area = glm::length(glm::cross(b - a, c - a));
+
+				// slivers are skipped, they would ask for an endless number of steps
+				if (longest > 0.0f && area / longest > margin) {
+					thinnest = std::min(thinnest, area / longest);
+				}
+			}
+		}
+
+		return std::max(thinnest == FLT_MAX ? margin : thinnest * 0.5f, margin);
+	}
+
+private:
+	// largest distance between two corners of a face
+	static float faceSize(const FaceAdjacency &adjacency, int face) {
+		const vector<glm::vec3> &positions = adjacency.restPositions[face];
+		float size = 0.0f;
+
+		for (int i = 0; i < positions.size(); i++) {
+			for (int j = i + 1; j < positions.size(); j++) {
+				size = std::max(size, glm::length(positions[j] - positions[i]));
+			}
+		}
+
+		return size;
+	}
+
+	// posed triangles of every face for a progress value
+	struct Sweep {
+		const FaceAdjacency &adjacency;
+		const UnfoldTree &tree;
+
+		vector<vector<glm::vec3>> triangles;
+		TriangleBVH hierarchy;
+
+		// rest and posed triangle corners for the transform kernel
+		GeometryKernels::FacePositions rest;
+		GeometryKernels::FacePositions posed;
+
+		float margin;
+
+		// progress the hierarchy was last built at
+		float builtAt;
+
+		Sweep(const FaceAdjacency &adjacency, const UnfoldTree &tree) : adjacency(adjacency), tree(tree) {
+			margin = glm::length(adjacency.restMax - adjacency.restMin) * 0.0001f;
+
+			rest = GeometryKernels::gather(adjacency.restPositions, adjacency.indices);
+
+			pose(0.0f);
+			hierarchy = TriangleBVH(triangles, margin);
+			builtAt = 0.0f;
+		}
+
+		void pose(float progress) {
+			GeometryKernels::transformTriangles(rest, tree.faceTransforms(adjacency, progress), posed);
+
+			triangles.resize(adjacency.size());
+			for (int i = 0; i < adjacency.size(); i++) {
+				triangles[i].resize(adjacency.indices[i].size());
+
+				for (int j = posed.triangleStart[i], k = 0; j < posed.triangleStart[i + 1]; j++, k += 3) {
+					triangles[i][k] = glm::vec3(posed.ax[j], posed.ay[j], posed.az[j]);
+					triangles[i][k + 1] = glm::vec3(posed.bx[j], posed.by[j], posed.bz[j]);
+					triangles[i][k + 2] = glm::vec3(posed.cx[j], posed.cy[j], posed.cz[j]);
+				}
+			}
+		}
+
+		// returns the lowest pair of colliding faces at this progress
+		bool findCollision(float progress, int &faceA, int &faceB) {
+			pose(progress);
+
+			if (std::abs(progress - builtAt) >= rebuildInterval) {
+				hierarchy = TriangleBVH(triangles, margin);
+				builtAt = progress;
+			}
+			else {
+				hierarchy.refit(triangles);
+			}
+
+			bool found = false;
+			hierarchy.selfPairs([&](int itemA, int itemB) {
+				int a = hierarchy.getFace(itemA);
+				int b = hierarchy.getFace(itemB);
+
+				if (adjacency.findEdge(a, b) != -1 || adjacency.findEdge(b, a) != -1) {
+					return;
+				}
+
+				if (found && std::make_pair(std::min(a, b), std::max(a, b)) >= std::make_pair(faceA, faceB)) {
+					return;
+				}
+
+				if (trianglesIntersect(&triangles[a][hierarchy.getOffset(itemA)], &triangles[b][hierarchy.getOffset(itemB)], margin)) {
+					found = true;
+					faceA = std::min(a, b);
+					faceB = std::max(a, b);
+				}
+			});
+
+			return found;
+		}
+	};
+
+	static float snap(float distance, float margin) {
+		return std::abs(distance) <= margin ? 0.0f : distance;
+	}
+
+	// true if no corner is on the other side (a triangle that only touches the plane can not cross it)
+	static bool sameSide(const float* distance) {
+		bool positive = distance[0] > 0 || distance[1] > 0 || distance[2] > 0;
+		bool negative = distance[0] < 0 || distance[1] < 0 || distance[2] < 0;
+
+		return !(positive && negative) && (positive || negative);
+	}
+
+	// the part of the line (as positions along the direction) where the triangle meets the other plane
+	static bool lineInterval(const glm::vec3* triangle, const float* distance, glm::vec3 direction, float &min, float &max) {
+		min = FLT_MAX;
+		max = -FLT_MAX;
+
+		for (int i = 0; i < 3; i++) {
+			int j = (i + 1) % 3;
+
+			float projectI = glm::dot(triangle[i], direction);
+			float projectJ = glm::dot(triangle[j], direction);
+
+			if (distance[i] == 0) {
+				min = std::min(min, projectI);
+				max = std::max(max, projectI);
+			}
+
+			if (distance[i] * distance[j] < 0) {
+				float crossing = projectI + (projectJ - projectI) * distance[i] / (distance[i] - distance[j]);
+
+				min = std::min(min, crossing);
+				max = std::max(max, crossing);
+			}
+		}
+
+		return min <= max;
+	}
+
+	// drop both triangles onto the shared plane and use the 2D overlap test
+	static bool coplanarOverlap(const glm::vec3* a, const glm::vec3* b, glm::vec3 normal, float margin) {
+		glm::vec3 u = glm::normalize(a[1] - a[0]);
+		glm::vec3 v = glm::cross(normal, u);
+
+		glm::vec2 flatA[3], flatB[3];
+		for (int i = 0; i < 3; i++) {
+			flatA[i] = glm::vec2(glm::dot(a[i] - a[0], u), glm::dot(a[i] - a[0], v));
+			flatB[i] = glm::vec2(glm::dot(b[i] - a[0], u), glm::dot(b[i] - a[0], v));
+		}
+
+		return NetValidation::trianglesOverlap(flatA, flatB, margin);
+	}
+};
+
+#endif
@@ -0,0 +1,389 @@
+#ifndef DYNAMICAABBTREE_H
+#define DYNAMICAABBTREE_H
+
+#include <glm/glm.hpp>
+
+#include <vector>
+#include <algorithm>
+
+using namespace std;
+
+// Bounding box hierarchy that can change one leaf at a time.
+// Leaves are inserted next to the sibling that grows the tree the least and the tree is kept balanced with rotations,
+// so moving a few boxes costs a few log(n) updates instead of rebuilding the whole hierarchy.
+// V is the point type (glm::vec2 or glm::vec3).
+template <class V>
+class DynamicAABBTree {
+public:
+	DynamicAABBTree(float fatten = 0.0f) {
+		this->fatten = fatten;
+
+		root = -1;
+		freeList = -1;
+	}
+
+	// add a box and return its proxy (a handle that stays valid until the box is removed)
+	int insert(V min, V max, int data) {
+		int proxy = allocateNode();
+
+		nodes[proxy].min = min - V(fatten);
+		nodes[proxy].max = max + V(fatten);
+		nodes[proxy].data = data;
+		nodes[proxy].height = 0;
+
+		insertLeaf(proxy);
+
+		return proxy;
+	}
+
+	void remove(int proxy) {
+		removeLeaf(proxy);
+		freeNode(proxy);
+	}
+
+	// move a box to new bounds
+	// nothing changes if the new bounds still fit in the fattened box, otherwise the leaf is taken out and inserted again
+	// returns true if the tree changed
+	bool update(int proxy, V min, V max) {
+		if (contains(nodes[proxy].min, nodes[proxy].max, min, max)) {
+			return false;
+		}
+
+		removeLeaf(proxy);
+
+		nodes[proxy].min = min - V(fatten);
+		nodes[proxy].max = max + V(fatten);
+
+		insertLeaf(proxy);
+
+		return true;
+	}
+
+	// shrink every inner box to exactly fit its children (after many leaves moved in place)
+	void refit() {
+		refit(root);
+	}
+
+	int getData(int proxy) const {
+		return nodes[proxy].data;
+	}
+
+	V getMin(int proxy) const {
+		return nodes[proxy].min;
+	}
+
+	V getMax(int proxy) const {
+		return nodes[proxy].max;
+	}
+
+	// call back with the data of every leaf whose box overlaps the given box by more than the margin
+	template <class F>
+	void query(V min, V max, float margin, F callback) const {
+		if (root == -1) {
+			return;
+		}
+
+		vector<int> stack;
+		stack.push_back(root);
+
+		while (!stack.empty()) {
+			int index = stack.back();
+			stack.pop_back();
+
+			const Node &node = nodes[index];
+			if (!overlaps(node.min, node.max, min, max, margin)) {
+				continue;
+			}
+
+			if (node.isLeaf()) {
+				callback(node.data);
+			}
+			else {
+				stack.push_back(node.left);
+				stack.push_back(node.right);
+			}
+		}
+	}
+
+	// height of the tree (0 for a single leaf, -1 when empty)
+	int getHeight() const {
+		return root == -1 ? -1 : nodes[root].height;
+	}
+
+private:
+	struct Node {
+		V min;
+		V max;
+
+		int parent;
+		int left, right;
+
+		// leaf data or the next free node
+		int data;
+
+		// -1 for free nodes
+		int height;
+
+		bool isLeaf() const {
+			return left == -1;
+		}
+	};
+
+	vector<Node> nodes;
+
+	int root;
+	int freeList;
+
+	float fatten;
+
+	int allocateNode() {
+		int index;
+
+		if (freeList != -1) {
+			index = freeList;
+			freeList = nodes[index].data;
+		}
+		else {
+			index = nodes.size();
+			nodes.push_back(Node());
+		}
+
+		nodes[index].parent = -1;
+		nodes[index].left = -1;
+		nodes[index].right = -1;
+		nodes[index].data = -1;
+		nodes[index].height = 0;
+
+		return index;
+	}
+
+	void freeNode(int index) {
+		nodes[index].data = freeList;
+		nodes[index].height = -1;
+		freeList = index;
+	}
+
+	void insertLeaf(int leaf) {
+		if (root == -1) {
+			root = leaf;
+			nodes[leaf].parent = -1;
+			return;
+		}
+
+		// walk down to the sibling that makes the tree grow the least
+		V leafMin = nodes[leaf].min;
+		V leafMax = nodes[leaf].max;
+
+		int index = root;
+		while (!nodes[index].isLeaf()) {
+			int left = nodes[index].left;
+			int right = nodes[index].right;
+
+			float size = perimeter(nodes[index].min, nodes[index].max);
+			float combined = perimeter(glm::min(nodes[index].min, leafMin), glm::max(nodes[index].max, leafMax));
+
+			// cost of making a new parent for this node and the leaf
+			float cost = 2.0f * combined;
+
+			// minimum cost of pushing the leaf further down
+			float inheritance = 2.0f * (combined - size);
+
+			float costLeft = descendCost(left, leafMin, leafMax) + inheritance;
+			float costRight = descendCost(right, leafMin, leafMax) + inheritance;
+
+			if (cost < costLeft && cost < costRight) {
+				break;
+			}
+
+			index = costLeft < costRight ? left : right;
+		}
+
+		int sibling = index;
+		int oldParent = nodes[sibling].parent;
+
+		int newParent = allocateNode();
+		nodes[newParent].parent = oldParent;
+		nodes[newParent].min = glm::min(leafMin, nodes[sibling].min);
+		nodes[newParent].max = glm::max(leafMax, nodes[sibling].max);
+		nodes[newParent].height = nodes[sibling].height + 1;
+		nodes[newParent].left = sibling;
+		nodes[newParent].right = leaf;
+
+		nodes[sibling].parent = newParent;
+		nodes[leaf].parent = newParent;
+
+		if (oldParent == -1) {
+			root = newParent;
+		}
+		else if (nodes[oldParent].left == sibling) {
+			nodes[oldParent].left = newParent;
+		}
+		else {
+			nodes[oldParent].right = newParent;
+		}
+
+		fixUpwards(newParent);
+	}
+
+	void removeLeaf(int leaf) {
+		if (leaf == root) {
+			root = -1;
+			return;
+		}
+
+		int parent = nodes[leaf].parent;
+		int grandParent = nodes[parent].parent;
+		int sibling = nodes[parent].left == leaf ? nodes[parent].right : nodes[parent].left;
+
+		// the sibling takes the place of the parent
+		if (grandParent == -1) {
+			root = sibling;
+			nodes[sibling].parent = -1;
+		}
+		else {
+			if (nodes[grandParent].left == parent) {
+				nodes[grandParent].left = sibling;
+			}
+			else {
+				nodes[grandParent].right = sibling;
+			}
+			nodes[sibling].parent = grandParent;
+
+			fixUpwards(grandParent);
+		}
+
+		freeNode(parent);
+		nodes[leaf].parent = -1;
+	}
+
+	// cost of inserting the leaf below a child
+	float descendCost(int child, V leafMin, V leafMax) {
+		float combined = perimeter(glm::min(nodes[child].min, leafMin), glm::max(nodes[child].max, leafMax));
+
+		if (nodes[child].isLeaf()) {
+			return combined;
+		}
+
+		return combined - perimeter(nodes[child].min, nodes[child].max);
+	}
+
+	// rebalance and recompute the bounds and heights from a node up to the root
+	void fixUpwards(int index) {
+		while (index != -1) {
+			index = balance(index);
+
+			int left = nodes[index].left;
+			int right = nodes[index].right;
+
+			nodes[index].height = 1 + std::max(nodes[left].height, nodes[right].height);
+			nodes[index].min = glm::min(nodes[left].min, nodes[right].min);
+			nodes[index].max = glm::max(nodes[left].max, nodes[right].max);
+
+			index = nodes[index].parent;
+		}
+	}
+
+	// rotate the taller child up if the two children differ in height by more than one
+	// returns the node that is now in the place of the given node
+	int balance(int a) {
+		if (nodes[a].isLeaf() || nodes[a].height < 2) {
+			return a;
+		}
+
+		int b = nodes[a].left;
+		int c = nodes[a].right;
+
+		int difference = nodes[c].height - nodes[b].height;
+
+		if (difference > 1) {
+			return rotate(a, c, b);
+		}
+		if (difference < -1) {
+			return rotate(a, b, c);
+		}
+
+		return a;
+	}
+
+	// move the tall child up into the place of a, a keeps the short child and the shorter grandchild
+	int rotate(int a, int tall, int shortChild) {
+		int f = nodes[tall].left;
+		int g = nodes[tall].right;
+
+		// swap a and the tall child
+		nodes[tall].left = a;
+		nodes[tall].parent = nodes[a].parent;
+		nodes[a].parent = tall;
+
+		if (nodes[tall].parent == -1) {
+			root = tall;
+		}
+		else if (nodes[nodes[tall].parent].left == a) {
+			nodes[nodes[tall].parent].left = tall;
+		}
+		else {
+			nodes[nodes[tall].parent].right = tall;
+		}
+
+		// the taller grandchild stays with the tall node
+		int keep = f, give = g;
+		if (nodes[f].height < nodes[g].height) {
+			keep = g;
+			give = f;
+		}
+
+		nodes[tall].right = keep;
+
+		if (nodes[a].left == tall) {
+			nodes[a].left = give;
+		}
+		else {
+			nodes[a].right = give;
+		}
+		nodes[give].parent = a;
+
+		nodes[a].min = glm::min(nodes[shortChild].min, nodes[give].min);
+		nodes[a].max = glm::max(nodes[shortChild].max, nodes[give].max);
+		nodes[a].height = 1 + std::max(nodes[shortChild].height, nodes[give].height);
+
+		nodes[tall].min = glm::min(nodes[a].min, nodes[keep].min);
+		nodes[tall].max = glm::max(nodes[a].max, nodes[keep].max);
+		nodes[tall].height = 1 + std::max(nodes[a].height, nodes[keep].height);
+
+		return tall;
+	}
+
+	void refit(int index) {
+		if (index == -1 || nodes[index].isLeaf()) {
+			return;
+		}
+
+		refit(nodes[index].left);
+		refit(nodes[index].right);
+
+		nodes[index].min = glm::min(nodes[nodes[index].left].min, nodes[nodes[index].right].min);
+		nodes[index].max = glm::max(nodes[nodes[index].left].max, nodes[nodes[index].right].max);
+	}
+
+	// sum of the side lengths (the cost used to pick where a leaf goes)
+	static float perimeter(V min, V max) {
+		V size = max - min;
+
+		float sum = 0;
+		for (int i = 0; i < size.length(); i++) {
+			sum += size[i];
+		}
+
+		return sum;
+	}
+
+	static bool contains(V outerMin, V outerMax, V min, V max) {
+		return glm::all(glm::lessThanEqual(outerMin, min)) && glm::all(glm::lessThanEqual(max, outerMax));
+	}
+
+	static bool overlaps(V minA, V maxA, V minB, V maxB, float margin) {
+		return glm::all(glm::lessThan(minA, maxB - V(margin))) && glm::all(glm::lessThan(minB, maxA - V(margin)));
+	}
+};
+
+#endif
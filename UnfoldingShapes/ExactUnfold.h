@@ -0,0 +1,252 @@
+#ifndef EXACTUNFOLD_H
+#define EXACTUNFOLD_H
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+
+#include "FaceAdjacency.h"
+#include "NetValidation.h"
+#include "RootSelection.h"
+#include "Unfold.h"
+
+// Branch and bound search for the non-overlapping net with the smallest bounding box on the root plane.
+// The tree is grown one face at a time while tracking the running 2D bounds and checking the new face against every placed face.
+// Each frontier hinge is either folded (the face behind it is placed) or cut for the rest of that branch, so every spanning tree is visited at most once.
+// A branch is pruned as soon as its lower bound (the larger of the current bounding box and the total face area) reaches the best net found.
+// Only practical for small models (about 40 faces), which makes it useful as ground truth for the heuristic patterns.
+// The footprint is the axis aligned box in the root plane frame of NetValidation::rootPlane, so it depends on how that frame happens to be turned
+// and is only minimal for the given root; a net that would fit a smaller rotated rectangle (see OrientedBounds) can lose to one that does not.
+static class ExactUnfold {
+public:
+	static const int maxFaces = 40;
+
+	struct Result {
+		UnfoldTree tree;
+
+		// axis aligned bounding box area of the net in the root plane frame (FLT_MAX if no net without overlap was found)
+		float footprint;
+
+		// true when the search finished, false if it ran out of time or the model was too large
+		bool optimal;
+
+		// number of partial trees visited
+		long long nodes;
+
+		Result() {
+			footprint = FLT_MAX;
+			optimal = false;
+			nodes = 0;
+		}
+	};
+
+	// milliseconds of 0 lets the search run until it is complete
+	static Result solve(const FaceAdjacency &adjacency, int root, int milliseconds = 10000) {
+		Search search(adjacency, root, milliseconds);
+
+		// start from the best heuristic net so the first bound is already tight
+		RootSelection::Pattern patterns[] = { RootSelection::BREADTH_FIRST, RootSelection::DEPTH_FIRST, RootSelection::SOURCE };
+		for (int i = 0; i < 3; i++) {
+			UnfoldTree tree = RootSelection::buildTree(adjacency, root, patterns[i]);
+			RootSelection::Score score = RootSelection::scoreTree(adjacency, tree);
+
+			if (score.overlaps == 0 && score.footprint < search.result.footprint) {
+				search.result.tree = tree;
+				search.result.footprint = score.footprint;
+			}
+		}
+
+		if (adjacency.size() > maxFaces) {
+			std::cout << "Exact unfold skipped: " << adjacency.size() << " faces is more than " << maxFaces << std::endl;
+			return search.result;
+		}
+
+		search.run();
+
+		return search.result;
+	}
+
+private:
+	// a hinge from a placed face to a face that is not placed yet
+	struct Frontier {
+		int face;
+		int edge;
+
+		Frontier(int face, int edge) {
+			this->face = face;
+			this->edge = edge;
+		}
+	};
+
+	struct Search {
+		const FaceAdjacency &adjacency;
+		Result result;
+
+		UnfoldTree tree;
+		vector<glm::mat4> transforms;
+
+		// flattened triangles and bounds per placed face
+		vector<vector<glm::vec2>> triangles;
+		vector<glm::vec2> faceMin;
+		vector<glm::vec2> faceMax;
+		vector<int> placed;
+
+		// root plane
+		glm::vec3 origin, u, v;
+
+		float totalArea;
+		float margin;
+
+		int milliseconds;
+		bool timedOut;
+		std::chrono::steady_clock::time_point startTime;
+
+		Search(const FaceAdjacency &adjacency, int root, int milliseconds) : adjacency(adjacency) {
+			this->milliseconds = milliseconds;
+			timedOut = false;
+
+			int n = adjacency.size();
+			tree = UnfoldTree(n, root);
+			transforms = vector<glm::mat4>(n, glm::mat4(1.0f));
+			triangles = vector<vector<glm::vec2>>(n);
+			faceMin = vector<glm::vec2>(n);
+			faceMax = vector<glm::vec2>(n);
+
+			NetValidation::rootPlane(adjacency, root, origin, u, v);
+
+			// area of every face (a net without overlap can never be smaller) and the model size for the overlap margin
+			totalArea = 0;
+			for (int i = 0; i < n; i++) {
+				totalArea += adjacency.areas[i];
+			}
+			margin = glm::length(adjacency.restMax - adjacency.restMin) * 0.0001f;
+		}
+
+		void run() {
+			startTime = std::chrono::steady_clock::now();
+
+			int root = tree.root;
+			place(root);
+
+			vector<Frontier> frontier;
+			addFrontier(root, frontier);
+
+			branch(frontier, faceMin[root], faceMax[root]);
+
+			result.optimal = !timedOut && result.footprint < FLT_MAX;
+		}
+
+		void branch(vector<Frontier> frontier, glm::vec2 min, glm::vec2 max) {
+			result.nodes++;
+
+			if ((result.nodes & 1023) == 0 && milliseconds > 0) {
+				std::chrono::milliseconds elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime);
+				if (elapsed.count() >= milliseconds) {
+					timedOut = true;
+				}
+			}
+
+			if (timedOut) {
+				return;
+			}
+
+			glm::vec2 bounds = max - min;
+			float area = bounds.x * bounds.y;
+
+			// every face is placed
+			if (placed.size() == adjacency.size()) {
+				if (area < result.footprint) {
+					result.footprint = area;
+					result.tree = tree;
+				}
+				return;
+			}
+
+			// bound
+			if (std::max(area, totalArea) >= result.footprint) {
+				return;
+			}
+
+			// drop hinges to faces that were placed through another hinge
+			while (!frontier.empty() && tree.contains(adjacency.edges[frontier.back().face][frontier.back().edge].neighbor)) {
+				frontier.pop_back();
+			}
+
+			// some face can no longer be reached
+			if (frontier.empty()) {
+				return;
+			}
+
+			Frontier next = frontier.back();
+			frontier.pop_back();
+
+			int child = adjacency.edges[next.face][next.edge].neighbor;
+
+			// fold the hinge
+			tree.attach(next.face, child, next.edge);
+			place(child);
+
+			if (!overlapsPlaced(child)) {
+				vector<Frontier> folded = frontier;
+				addFrontier(child, folded);
+
+				branch(folded, glm::min(min, faceMin[child]), glm::max(max, faceMax[child]));
+			}
+
+			unplace();
+			tree.detach(child);
+
+			// cut the hinge
+			branch(frontier, min, max);
+		}
+
+		// flatten a face whose parent is already placed
+		void place(int face) {
+			if (face != tree.root) {
+				transforms[face] = transforms[tree.parent[face]] * tree.hingeTransform(adjacency, face);
+			}
+
+			NetValidation::flattenFace(adjacency, face, transforms[face], origin, u, v, triangles[face], faceMin[face], faceMax[face]);
+
+			placed.push_back(face);
+		}
+
+		// undo the last place
+		void unplace() {
+			placed.pop_back();
+		}
+
+		bool overlapsPlaced(int face) {
+			for (int i = 0; i + 1 < placed.size(); i++) {
+				int other = placed[i];
+
+				if (faceMin[other].x >= faceMax[face].x - margin || faceMin[face].x >= faceMax[other].x - margin ||
+					faceMin[other].y >= faceMax[face].y - margin || faceMin[face].y >= faceMax[other].y - margin) {
+					continue;
+				}
+
+				if (NetValidation::facesOverlap(triangles[face], triangles[other], margin)) {
+					return true;
+				}
+			}
+
+			return false;
+		}
+
+		// hinges are pushed in reverse so the first hinge of a face is decided first
+		void addFrontier(int face, vector<Frontier> &frontier) {
+			for (int i = adjacency.edges[face].size() - 1; i >= 0; i--) {
+				if (!tree.contains(adjacency.edges[face][i].neighbor)) {
+					frontier.push_back(Frontier(face, i));
+				}
+			}
+		}
+	};
+};
+
+#endif
@@ -0,0 +1,359 @@
+#ifndef FACEADJACENCY_H
+#define FACEADJACENCY_H
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtx/string_cast.hpp>
+#include <glm/gtx/vector_angle.hpp>
+
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <unordered_map>
+
+#include "Face.h"
+#include "Graph.h"
+#include "Axis.h"
+#include "GeometryKernels.h"
+
+// Index based copy of the connectivity of a shape's faces.
+// It is built once while the shape is in its rest pose and never modified afterwards,
+// so any number of threads can read it at the same time without locking.
+class FaceAdjacency {
+public:
+	// one hinge of a face (stored from the point of view of the face that owns the axis)
+	struct Edge {
+		// index of the face on the other side of the hinge
+		int neighbor;
+
+		// the axis on the owning face that matches the neighbor
+		Axis<Face>* axis;
+
+		// rest state of the hinge
+		glm::vec3 point;
+		glm::vec3 line;
+		glm::vec3 p1, p2;
+
+		// rotation that lays the neighbor flat with the owning face (the dihedral angle of the hinge, also copied to the axis original angle)
+		float angle;
+	};
+
+	vector<Face*> faces;
+
+	// rest pose geometry per face
+	vector<vector<glm::vec3>> restPositions;
+	vector<vector<unsigned int>> indices;
+	vector<glm::vec3> centroids;
+	vector<glm::vec3> normals;
+	vector<float> areas;
+
+	// bounds of every rest position
+	glm::vec3 restMin;
+	glm::vec3 restMax;
+
+	// hinges per face
+	vector<vector<Edge>> edges;
+
+	FaceAdjacency() {
+		restMin = glm::vec3(0);
+		restMax = glm::vec3(0);
+	}
+
+	// the faces must be in their rest pose and have their axis neighbors assigned
+	FaceAdjacency(const vector<Face*> &faces) {
+		build(faces);
+	}
+
+	int size() const {
+		return faces.size();
+	}
+
+	// returns -1 if the face is not part of the shape
+	int indexOf(Face* face) const {
+		unordered_map<Face*, int>::const_iterator it = faceIndex.find(face);
+
+		if (it == faceIndex.end()) {
+			return -1;
+		}
+
+		return it->second;
+	}
+
+	// returns the index of the hinge on face "from" that connects to face "to" (or -1 if they are not neighbors)
+	int findEdge(int from, int to) const {
+		for (int i = 0; i < edges[from].size(); i++) {
+			if (edges[from][i].neighbor == to) {
+				return i;
+			}
+		}
+
+		return -1;
+	}
+
+private:
+	unordered_map<Face*, int> faceIndex;
+
+	void build(const vector<Face*> &faces) {
+		this->faces = faces;
+
+		faceIndex.clear();
+		for (int i = 0; i < faces.size(); i++) {
+			faceIndex[faces[i]] = i;
+		}
+
+		restPositions = vector<vector<glm::vec3>>(faces.size());
+		indices = vector<vector<unsigned int>>(faces.size());
+		centroids = vector<glm::vec3>(faces.size());
+		normals = vector<glm::vec3>(faces.size());
+		edges = vector<vector<Edge>>(faces.size());
+
+		for (int i = 0; i < faces.size(); i++) {
+			Mesh* mesh = faces[i]->mesh;
+
+			for (int j = 0; j < mesh->vertices.size(); j++) {
+				restPositions[i].push_back(mesh->vertices[j].Position);
+			}
+			indices[i] = mesh->indices;
+
+			// keep the first axis that leads to each neighbor (same rule the update functions use to find a hinge)
+			for (int j = 0; j < faces[i]->axis.size(); j++) {
+				Axis<Face>* axis = faces[i]->axis[j];
+				int neighbor = indexOf(axis->neighborFace);
+
+				if (neighbor == -1 || neighbor == i || findEdge(i, neighbor) != -1) {
+					continue;
+				}
+
+				Edge edge;
+				edge.neighbor = neighbor;
+				edge.axis = axis;
+				edge.point = axis->originalPoint;
+				edge.line = axis->originalLine;
+				edge.p1 = axis->p1;
+				edge.p2 = axis->p2;
+				edge.angle = 0.0f;
+
+				edges[i].push_back(edge);
+			}
+		}
+
+		// centroids, normals, areas and bounds of every face in one pass of the geometry kernels
+		GeometryKernels::FacePositions soa = GeometryKernels::gather(restPositions, indices);
+
+		GeometryKernels::faceCentroids(soa, centroids);
+		GeometryKernels::faceNormalsAndAreas(soa, normals, areas);
+		GeometryKernels::bounds(soa, restMin, restMax);
+
+		for (int i = 0; i < normals.size(); i++) {
+			normals[i] = glm::normalize(normals[i]);
+		}
+
+		// one pass over the edge index fills in the fold angle of every hinge
+		for (int i = 0; i < edges.size(); i++) {
+			for (int j = 0; j < edges[i].size(); j++) {
+				edges[i][j].angle = dihedralAngle(i, edges[i][j]);
+				edges[i][j].axis->originalAngle = edges[i][j].angle;
+			}
+		}
+	}
+
+	// the rotation about the hinge line that turns the neighbor's normal onto the face's normal
+	// this only holds when both faces are wound the same way, so a neighbor wound the other way has its normal flipped first
+	float dihedralAngle(int face, const Edge &edge) const {
+		glm::vec3 line = glm::normalize(edge.line);
+		glm::vec3 normal = normals[face];
+		glm::vec3 neighborNormal = normals[edge.neighbor];
+
+		// seen along the hinge, faces wound the same way have their normals turned opposite ways from the direction into the face
+		float winding = glm::dot(normal, glm::cross(line, centroids[face] - edge.point));
+		float neighborWinding = glm::dot(neighborNormal, glm::cross(line, centroids[edge.neighbor] - edge.point));
+
+		if (winding * neighborWinding > 0.0f) {
+			neighborNormal = -neighborNormal;
+		}
+
+		return glm::orientedAngle(neighborNormal, normal, line);
+	}
+};
+
+// Index based spanning tree over a FaceAdjacency.
+// parent[i] is -1 for the root and for faces that are not attached yet.
+struct UnfoldTree {
+	int root;
+
+	vector<int> parent;
+
+	// index into adjacency.edges[parent[i]] of the hinge that connects face i to its parent
+	vector<int> parentEdge;
+
+	vector<vector<int>> children;
+
+	UnfoldTree() {
+		root = -1;
+	}
+
+	UnfoldTree(int faceCount, int root) {
+		this->root = root;
+
+		parent = vector<int>(faceCount, -1);
+		parentEdge = vector<int>(faceCount, -1);
+		children = vector<vector<int>>(faceCount);
+	}
+
+	int size() const {
+		return parent.size();
+	}
+
+	void attach(int parentFace, int child, int edge) {
+		parent[child] = parentFace;
+		parentEdge[child] = edge;
+		children[parentFace].push_back(child);
+	}
+
+	// removes the face from its parent (the subtree below it stays attached to the face)
+	void detach(int child) {
+		if (parent[child] == -1) {
+			return;
+		}
+
+		vector<int> &siblings = children[parent[child]];
+		siblings.erase(std::find(siblings.begin(), siblings.end(), child));
+
+		parent[child] = -1;
+		parentEdge[child] = -1;
+	}
+
+	bool contains(int face) const {
+		return face == root || parent[face] != -1;
+	}
+
+	// true if the face is the ancestor or the same face as the other face
+	bool isAncestor(int ancestor, int face) const {
+		while (face != -1) {
+			if (face == ancestor) {
+				return true;
+			}
+
+			face = parent[face];
+		}
+
+		return false;
+	}
+
+	// breadth first order of the tree (every parent comes before its children)
+	vector<int> order() const {
+		return order(root);
+	}
+
+	// breadth first order of the subtree below a face
+	vector<int> order(int from) const {
+		vector<int> queue;
+
+		if (from == -1) {
+			return queue;
+		}
+
+		queue.push_back(from);
+		for (int i = 0; i < queue.size(); i++) {
+			for (int j = 0; j < children[queue[i]].size(); j++) {
+				queue.push_back(children[queue[i]][j]);
+			}
+		}
+
+		return queue;
+	}
+
+	// world transform of every face with each hinge rotated by (angle * progress) about its rest axis
+	// the transform of a child is the transform of its parent followed by the rotation about the hinge they share
+	vector<glm::mat4> faceTransforms(const FaceAdjacency &adjacency, float progress = 1.0f) const {
+		vector<glm::mat4> transforms(size(), glm::mat4(1.0f));
+
+		updateTransforms(adjacency, transforms, root, progress);
+
+		return transforms;
+	}
+
+	// same as above with a progress for every hinge (indexed by the child face of the hinge)
+	vector<glm::mat4> faceTransforms(const FaceAdjacency &adjacency, const vector<float> &progress) const {
+		vector<glm::mat4> transforms(size(), glm::mat4(1.0f));
+
+		vector<int> queue = order();
+		for (int i = 1; i < queue.size(); i++) {
+			int face = queue[i];
+
+			transforms[face] = transforms[parent[face]] * hingeTransform(adjacency, face, progress[face]);
+		}
+
+		return transforms;
+	}
+
+	// recompute the transforms of every face below (and including) the given face, the parent transform must be up to date
+	void updateTransforms(const FaceAdjacency &adjacency, vector<glm::mat4> &transforms, int from, float progress = 1.0f) const {
+		vector<int> queue = order(from);
+
+		for (int i = 0; i < queue.size(); i++) {
+			int face = queue[i];
+
+			if (parent[face] == -1) {
+				transforms[face] = glm::mat4(1.0f);
+				continue;
+			}
+
+			transforms[face] = transforms[parent[face]] * hingeTransform(adjacency, face, progress);
+		}
+	}
+
+	// rotation about the hinge between a face and its parent
+	glm::mat4 hingeTransform(const FaceAdjacency &adjacency, int face, float progress = 1.0f) const {
+		const FaceAdjacency::Edge &edge = adjacency.edges[parent[face]][parentEdge[face]];
+
+		glm::mat4 hinge(1.0f);
+		hinge = glm::translate(hinge, edge.point);
+		hinge = glm::rotate(hinge, edge.angle * progress, edge.line);
+		hinge = glm::translate(hinge, -edge.point);
+
+		return hinge;
+	}
+
+	// build the Graph used by the animation functions
+	Graph<Face>* toGraph(const FaceAdjacency &adjacency) const {
+		Graph<Face>* graph = new Graph<Face>(adjacency.faces[root]);
+
+		vector<Graph<Face>::Node*> nodes(size(), nullptr);
+		nodes[root] = graph->rootNode;
+
+		vector<int> queue = order();
+		for (int i = 1; i < queue.size(); i++) {
+			nodes[queue[i]] = graph->appendNode(nodes[parent[queue[i]]], adjacency.faces[queue[i]]);
+		}
+
+		return graph;
+	}
+
+	// convert a Graph solution (eg: one of the Unfold patterns) into an index based tree
+	// children without a hinge to their parent are dropped just like the update functions skip them
+	static UnfoldTree fromGraph(const FaceAdjacency &adjacency, Graph<Face>* graph) {
+		UnfoldTree tree(adjacency.size(), adjacency.indexOf(graph->rootNode->data));
+
+		vector<Graph<Face>::Node*> queue;
+		queue.push_back(graph->rootNode);
+
+		for (int i = 0; i < queue.size(); i++) {
+			int current = adjacency.indexOf(queue[i]->data);
+
+			for (int j = 0; j < queue[i]->connections.size(); j++) {
+				int child = adjacency.indexOf(queue[i]->connections[j]->data);
+				int edge = adjacency.findEdge(current, child);
+
+				if (child != -1 && edge != -1 && !tree.contains(child)) {
+					tree.attach(current, child, edge);
+					queue.push_back(queue[i]->connections[j]);
+				}
+			}
+		}
+
+		return tree;
+	}
+};
+
+#endif
@@ -0,0 +1,579 @@
+#ifndef GEOMETRYKERNELS_H
+#define GEOMETRYKERNELS_H
+
+#include <glm/glm.hpp>
+
+#include <vector>
+#include <cfloat>
+#include <cmath>
+
+#include <immintrin.h>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define KERNEL_AVX2
+#else
+#define KERNEL_AVX2 __attribute__((target("avx2")))
+#endif
+
+using namespace std;
+
+// Bulk versions of the per face geometry (Mesh::getAvgPos, Mesh::getNormal, Face::getArea and bounding boxes)
+// and of posing the faces by their transforms, that run over the positions of every face at once.
+// The positions are copied into structure of arrays form so 8 (AVX2) or 4 (SSE) triangles or coordinates are handled per instruction,
+// the instruction set is picked at runtime and the plain loops are kept as the fallback.
+static class GeometryKernels {
+public:
+	enum Level {
+		SCALAR = 0,
+		SSE = 1,
+		AVX2 = 2
+	};
+
+	// the positions of many faces in structure of arrays form
+	struct FacePositions {
+		// every vertex, face after face
+		vector<float> x, y, z;
+		vector<int> vertexStart;
+
+		// 3 corners per triangle, face after face
+		vector<float> ax, ay, az;
+		vector<float> bx, by, bz;
+		vector<float> cx, cy, cz;
+		vector<int> triangleStart;
+
+		// the face each triangle belongs to
+		vector<int> triangleFace;
+
+		int size() const {
+			return (int)vertexStart.size() - 1;
+		}
+
+		int vertexCount() const {
+			return x.size();
+		}
+
+		int triangleCount() const {
+			return ax.size();
+		}
+	};
+
+	// copy the vertices and triangles of every face (positions per face with 3 indices per triangle, like FaceAdjacency)
+	static FacePositions gather(const vector<vector<glm::vec3>> &positions, const vector<vector<unsigned int>> &indices) {
+		FacePositions soa;
+
+		soa.vertexStart.push_back(0);
+		soa.triangleStart.push_back(0);
+
+		for (int i = 0; i < positions.size(); i++) {
+			for (int j = 0; j < positions[i].size(); j++) {
+				soa.x.push_back(positions[i][j].x);
+				soa.y.push_back(positions[i][j].y);
+				soa.z.push_back(positions[i][j].z);
+			}
+
+			for (int j = 0; j + 2 < indices[i].size(); j += 3) {
+				glm::vec3 a = positions[i][indices[i][j]];
+				glm::vec3 b = positions[i][indices[i][j + 1]];
+				glm::vec3 c = positions[i][indices[i][j + 2]];
+
+				soa.ax.push_back(a.x);
+				soa.ay.push_back(a.y);
+				soa.az.push_back(a.z);
+				soa.bx.push_back(b.x);
+				soa.by.push_back(b.y);
+				soa.bz.push_back(b.z);
+				soa.cx.push_back(c.x);
+				soa.cy.push_back(c.y);
+				soa.cz.push_back(c.z);
+
+				soa.triangleFace.push_back(i);
+			}
+
+			soa.vertexStart.push_back(soa.x.size());
+			soa.triangleStart.push_back(soa.ax.size());
+		}
+
+		return soa;
+	}
+
+	// the best instruction set this processor supports (found once)
+	static Level supportedLevel() {
+		static Level level = detectLevel();
+		return level;
+	}
+
+	// the instruction set the kernels use, lower than the supported level only if it was set lower
+	static Level getLevel() {
+		return activeLevel();
+	}
+
+	// limit the kernels to an instruction set (eg: to compare the results of each path)
+	static void setLevel(Level level) {
+		activeLevel() = level < supportedLevel() ? level : supportedLevel();
+	}
+
+	// average position of the vertices of every face (Mesh::getAvgPos)
+	static void faceCentroids(const FacePositions &soa, vector<glm::vec3> &centroids) {
+		centroids.resize(soa.size());
+
+		for (int i = 0; i < soa.size(); i++) {
+			int start = soa.vertexStart[i];
+			int count = soa.vertexStart[i + 1] - start;
+
+			if (count == 0) {
+				centroids[i] = glm::vec3(0);
+				continue;
+			}
+
+			glm::vec3 total(sum(&soa.x[start], count), sum(&soa.y[start], count), sum(&soa.z[start], count));
+			centroids[i] = total / (float)count;
+		}
+	}
+
+	// unit normal and area of every triangle (a triangle without area gets a zero normal)
+	static void triangleNormals(const FacePositions &soa, vector<glm::vec3> &normals, vector<float> &areas) {
+		vector<float> nx, ny, nz;
+		triangleNormals(soa, nx, ny, nz, areas);
+
+		normals.resize(nx.size());
+		for (int i = 0; i < nx.size(); i++) {
+			normals[i] = glm::vec3(nx[i], ny[i], nz[i]);
+		}
+	}
+
+	// average of the unit triangle normals (Mesh::getNormal) and the total area (Face::getArea) of every face
+	static void faceNormalsAndAreas(const FacePositions &soa, vector<glm::vec3> &normals, vector<float> &areas) {
+		vector<float> nx, ny, nz, triangleArea;
+		triangleNormals(soa, nx, ny, nz, triangleArea);
+
+		normals.resize(soa.size());
+		areas.resize(soa.size());
+
+		for (int i = 0; i < soa.size(); i++) {
+			glm::vec3 normal(0);
+			float area = 0;
+
+			for (int j = soa.triangleStart[i]; j < soa.triangleStart[i + 1]; j++) {
+				normal += glm::vec3(nx[j], ny[j], nz[j]);
+				area += triangleArea[j];
+			}
+
+			int count = soa.triangleStart[i + 1] - soa.triangleStart[i];
+			normals[i] = count > 0 ? normal / (float)count : glm::vec3(0);
+			areas[i] = area;
+		}
+	}
+
+	// bounding box of every vertex
+	static void bounds(const FacePositions &soa, glm::vec3 &min, glm::vec3 &max) {
+		range(soa.x.empty() ? nullptr : &soa.x[0], soa.vertexCount(), 1, min.x, max.x);
+		range(soa.y.empty() ? nullptr : &soa.y[0], soa.vertexCount(), 1, min.y, max.y);
+		range(soa.z.empty() ? nullptr : &soa.z[0], soa.vertexCount(), 1, min.z, max.z);
+	}
+
+	// bounding box of packed 2D points (x and y alternate, so each register holds the same coordinate in every other lane)
+	static void bounds(const glm::vec2* points, int count, glm::vec2 &min, glm::vec2 &max) {
+		float low[2], high[2];
+		range(count > 0 ? &points[0].x : nullptr, count * 2, 2, low, high);
+
+		min = glm::vec2(low[0], low[1]);
+		max = glm::vec2(high[0], high[1]);
+	}
+
+	// move the triangle corners of every face by the rigid transform of that face
+	// posed takes the layout of rest the first time, after that only the corners are written (the vertex arrays are not posed)
+	// each lane reads the rotation and translation of its own triangle's face, so faces of any size fill the registers
+	static void transformTriangles(const FacePositions &rest, const vector<glm::mat4> &transforms, FacePositions &posed) {
+		int count = rest.triangleCount();
+
+		if (posed.triangleCount() != count) {
+			posed = rest;
+		}
+
+		if (count == 0) {
+			return;
+		}
+
+		int done = 0;
+		switch (getLevel()) {
+		case AVX2:
+			done = transformTrianglesAVX2(rest, &transforms[0][0][0], count, posed);
+			break;
+		case SSE:
+			done = transformTrianglesSSE(rest, &transforms[0][0][0], count, posed);
+			break;
+		default:
+			break;
+		}
+
+		for (int i = done; i < count; i++) {
+			const glm::mat4 &transform = transforms[rest.triangleFace[i]];
+
+			glm::vec3 a = glm::vec3(transform * glm::vec4(rest.ax[i], rest.ay[i], rest.az[i], 1.0f));
+			glm::vec3 b = glm::vec3(transform * glm::vec4(rest.bx[i], rest.by[i], rest.bz[i], 1.0f));
+			glm::vec3 c = glm::vec3(transform * glm::vec4(rest.cx[i], rest.cy[i], rest.cz[i], 1.0f));
+
+			posed.ax[i] = a.x;
+			posed.ay[i] = a.y;
+			posed.az[i] = a.z;
+			posed.bx[i] = b.x;
+			posed.by[i] = b.y;
+			posed.bz[i] = b.z;
+			posed.cx[i] = c.x;
+			posed.cy[i] = c.y;
+			posed.cz[i] = c.z;
+		}
+	}
+
+	// sum of an array
+	static float sum(const float* values, int count) {
+		float total = 0;
+
+		// short arrays (like the 3 corners of a triangle) are not worth filling a register for
+		int done = 0;
+		switch (count < minimumVector ? SCALAR : getLevel()) {
+		case AVX2:
+			done = sumAVX2(values, count, total);
+			break;
+		case SSE:
+			done = sumSSE(values, count, total);
+			break;
+		default:
+			break;
+		}
+
+		for (int i = done; i < count; i++) {
+			total += values[i];
+		}
+
+		return total;
+	}
+
+private:
+	// arrays shorter than this are summed (or bounded) with the plain loop
+	static const int minimumVector = 16;
+
+	static Level &activeLevel() {
+		static Level level = supportedLevel();
+		return level;
+	}
+
+	// per triangle normals as separate x, y and z arrays
+	static void triangleNormals(const FacePositions &soa, vector<float> &nx, vector<float> &ny, vector<float> &nz, vector<float> &areas) {
+		int count = soa.triangleCount();
+
+		nx.resize(count);
+		ny.resize(count);
+		nz.resize(count);
+		areas.resize(count);
+
+		if (count == 0) {
+			return;
+		}
+
+		int done = 0;
+		switch (getLevel()) {
+		case AVX2:
+			done = triangleNormalsAVX2(soa, count, &nx[0], &ny[0], &nz[0], &areas[0]);
+			break;
+		case SSE:
+			done = triangleNormalsSSE(soa, count, &nx[0], &ny[0], &nz[0], &areas[0]);
+			break;
+		default:
+			break;
+		}
+
+		// the triangles that did not fill a whole register
+		for (int i = done; i < count; i++) {
+			glm::vec3 a(soa.ax[i], soa.ay[i], soa.az[i]);
+			glm::vec3 cross = glm::cross(glm::vec3(soa.bx[i], soa.by[i], soa.bz[i]) - a, glm::vec3(soa.cx[i], soa.cy[i], soa.cz[i]) - a);
+			float length = std::sqrt(glm::dot(cross, cross));
+
+			glm::vec3 normal = length > 0 ? cross / length : glm::vec3(0);
+			nx[i] = normal.x;
+			ny[i] = normal.y;
+			nz[i] = normal.z;
+			areas[i] = length * 0.5f;
+		}
+	}
+
+	static Level detectLevel() {
+#if defined(_MSC_VER)
+		int info[4];
+		__cpuid(info, 0);
+		int highest = info[0];
+
+		__cpuid(info, 1);
+		bool sse = (info[3] & (1 << 25)) != 0;
+		bool osSavesAVX = (info[2] & (1 << 27)) != 0 && (info[2] & (1 << 28)) != 0 && (_xgetbv(0) & 6) == 6;
+
+		bool avx2 = false;
+		if (highest >= 7 && osSavesAVX) {
+			__cpuidex(info, 7, 0);
+			avx2 = (info[1] & (1 << 5)) != 0;
+		}
+#else
+		__builtin_cpu_init();
+		bool sse = __builtin_cpu_supports("sse");
+		bool avx2 = __builtin_cpu_supports("avx2");
+#endif
+
+		if (avx2) {
+			return AVX2;
+		}
+		if (sse) {
+			return SSE;
+		}
+
+		return SCALAR;
+	}
+
+	// minimum and maximum of every lane of a repeating pattern of (stride) coordinates
+	static void range(const float* values, int count, int stride, float* min, float* max) {
+		for (int i = 0; i < stride; i++) {
+			min[i] = FLT_MAX;
+			max[i] = -FLT_MAX;
+		}
+
+		int done = 0;
+		switch (count < minimumVector ? SCALAR : getLevel()) {
+		case AVX2:
+			done = rangeAVX2(values, count, stride, min, max);
+			break;
+		case SSE:
+			done = rangeSSE(values, count, stride, min, max);
+			break;
+		default:
+			break;
+		}
+
+		for (int i = done; i < count; i++) {
+			min[i % stride] = std::min(min[i % stride], values[i]);
+			max[i % stride] = std::max(max[i % stride], values[i]);
+		}
+	}
+
+	static void range(const float* values, int count, int stride, float &min, float &max) {
+		range(values, count, stride, &min, &max);
+	}
+
+	// the SIMD paths return how many values they handled, the rest is finished by the scalar loop
+	// the register width is a multiple of the stride (1 or 2), so lane i always holds coordinate i % stride
+
+	static KERNEL_AVX2 int sumAVX2(const float* values, int count, float &total) {
+		int blocks = count / 8 * 8;
+		__m256 acc = _mm256_setzero_ps();
+
+		for (int i = 0; i < blocks; i += 8) {
+			acc = _mm256_add_ps(acc, _mm256_loadu_ps(values + i));
+		}
+
+		float lanes[8];
+		_mm256_storeu_ps(lanes, acc);
+		for (int i = 0; i < 8; i++) {
+			total += lanes[i];
+		}
+
+		return blocks;
+	}
+
+	static int sumSSE(const float* values, int count, float &total) {
+		int blocks = count / 4 * 4;
+		__m128 acc = _mm_setzero_ps();
+
+		for (int i = 0; i < blocks; i += 4) {
+			acc = _mm_add_ps(acc, _mm_loadu_ps(values + i));
+		}
+
+		float lanes[4];
+		_mm_storeu_ps(lanes, acc);
+		for (int i = 0; i < 4; i++) {
+			total += lanes[i];
+		}
+
+		return blocks;
+	}
+
+	static KERNEL_AVX2 int rangeAVX2(const float* values, int count, int stride, float* min, float* max) {
+		int blocks = count / 8 * 8;
+		__m256 low = _mm256_set1_ps(FLT_MAX);
+		__m256 high = _mm256_set1_ps(-FLT_MAX);
+
+		for (int i = 0; i < blocks; i += 8) {
+			__m256 v = _mm256_loadu_ps(values + i);
+			low = _mm256_min_ps(low, v);
+			high = _mm256_max_ps(high, v);
+		}
+
+		float lowLanes[8], highLanes[8];
+		_mm256_storeu_ps(lowLanes, low);
+		_mm256_storeu_ps(highLanes, high);
+		for (int i = 0; i < 8; i++) {
+			min[i % stride] = std::min(min[i % stride], lowLanes[i]);
+			max[i % stride] = std::max(max[i % stride], highLanes[i]);
+		}
+
+		return blocks;
+	}
+
+	static int rangeSSE(const float* values, int count, int stride, float* min, float* max) {
+		int blocks = count / 4 * 4;
+		__m128 low = _mm_set1_ps(FLT_MAX);
+		__m128 high = _mm_set1_ps(-FLT_MAX);
+
+		for (int i = 0; i < blocks; i += 4) {
+			__m128 v = _mm_loadu_ps(values + i);
+			low = _mm_min_ps(low, v);
+			high = _mm_max_ps(high, v);
+		}
+
+		float lowLanes[4], highLanes[4];
+		_mm_storeu_ps(lowLanes, low);
+		_mm_storeu_ps(highLanes, high);
+		for (int i = 0; i < 4; i++) {
+			min[i % stride] = std::min(min[i % stride], lowLanes[i]);
+			max[i % stride] = std::max(max[i % stride], highLanes[i]);
+		}
+
+		return blocks;
+	}
+
+	// cross product of (b - a) and (c - a) for 8 triangles, then its length (twice the area) and the unit normal
+	static KERNEL_AVX2 int triangleNormalsAVX2(const FacePositions &soa, int count, float* nx, float* ny, float* nz, float* areas) {
+		int blocks = count / 8 * 8;
+		__m256 zero = _mm256_setzero_ps();
+		__m256 half = _mm256_set1_ps(0.5f);
+
+		for (int i = 0; i < blocks; i += 8) {
+			__m256 ax = _mm256_loadu_ps(&soa.ax[i]), ay = _mm256_loadu_ps(&soa.ay[i]), az = _mm256_loadu_ps(&soa.az[i]);
+
+			__m256 ux = _mm256_sub_ps(_mm256_loadu_ps(&soa.bx[i]), ax);
+			__m256 uy = _mm256_sub_ps(_mm256_loadu_ps(&soa.by[i]), ay);
+			__m256 uz = _mm256_sub_ps(_mm256_loadu_ps(&soa.bz[i]), az);
+			__m256 vx = _mm256_sub_ps(_mm256_loadu_ps(&soa.cx[i]), ax);
+			__m256 vy = _mm256_sub_ps(_mm256_loadu_ps(&soa.cy[i]), ay);
+			__m256 vz = _mm256_sub_ps(_mm256_loadu_ps(&soa.cz[i]), az);
+
+			__m256 x = _mm256_sub_ps(_mm256_mul_ps(uy, vz), _mm256_mul_ps(uz, vy));
+			__m256 y = _mm256_sub_ps(_mm256_mul_ps(uz, vx), _mm256_mul_ps(ux, vz));
+			__m256 z = _mm256_sub_ps(_mm256_mul_ps(ux, vy), _mm256_mul_ps(uy, vx));
+
+			__m256 length = _mm256_sqrt_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x, x), _mm256_mul_ps(y, y)), _mm256_mul_ps(z, z)));
+
+			// lanes without area keep a zero normal instead of dividing by zero
+			__m256 valid = _mm256_cmp_ps(length, zero, _CMP_GT_OQ);
+			__m256 inverse = _mm256_and_ps(valid, _mm256_div_ps(_mm256_set1_ps(1.0f), _mm256_max_ps(length, _mm256_set1_ps(FLT_MIN))));
+
+			_mm256_storeu_ps(nx + i, _mm256_mul_ps(x, inverse));
+			_mm256_storeu_ps(ny + i, _mm256_mul_ps(y, inverse));
+			_mm256_storeu_ps(nz + i, _mm256_mul_ps(z, inverse));
+			_mm256_storeu_ps(areas + i, _mm256_mul_ps(length, half));
+		}
+
+		return blocks;
+	}
+
+	static int triangleNormalsSSE(const FacePositions &soa, int count, float* nx, float* ny, float* nz, float* areas) {
+		int blocks = count / 4 * 4;
+		__m128 zero = _mm_setzero_ps();
+		__m128 half = _mm_set1_ps(0.5f);
+
+		for (int i = 0; i < blocks; i += 4) {
+			__m128 ax = _mm_loadu_ps(&soa.ax[i]), ay = _mm_loadu_ps(&soa.ay[i]), az = _mm_loadu_ps(&soa.az[i]);
+
+			__m128 ux = _mm_sub_ps(_mm_loadu_ps(&soa.bx[i]), ax);
+			__m128 uy = _mm_sub_ps(_mm_loadu_ps(&soa.by[i]), ay);
+			__m128 uz = _mm_sub_ps(_mm_loadu_ps(&soa.bz[i]), az);
+			__m128 vx = _mm_sub_ps(_mm_loadu_ps(&soa.cx[i]), ax);
+			__m128 vy = _mm_sub_ps(_mm_loadu_ps(&soa.cy[i]), ay);
+			__m128 vz = _mm_sub_ps(_mm_loadu_ps(&soa.cz[i]), az);
+
+			__m128 x = _mm_sub_ps(_mm_mul_ps(uy, vz), _mm_mul_ps(uz, vy));
+			__m128 y = _mm_sub_ps(_mm_mul_ps(uz, vx), _mm_mul_ps(ux, vz));
+			__m128 z = _mm_sub_ps(_mm_mul_ps(ux, vy), _mm_mul_ps(uy, vx));
+
+			__m128 length = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z)));
+
+			__m128 valid = _mm_cmpgt_ps(length, zero);
+			__m128 inverse = _mm_and_ps(valid, _mm_div_ps(_mm_set1_ps(1.0f), _mm_max_ps(length, _mm_set1_ps(FLT_MIN))));
+
+			_mm_storeu_ps(nx + i, _mm_mul_ps(x, inverse));
+			_mm_storeu_ps(ny + i, _mm_mul_ps(y, inverse));
+			_mm_storeu_ps(nz + i, _mm_mul_ps(z, inverse));
+			_mm_storeu_ps(areas + i, _mm_mul_ps(length, half));
+		}
+
+		return blocks;
+	}
+
+	// 8 triangles at a time, the 3x3 rotation and the translation of every lane are gathered from the (column major) matrices of their faces
+	static KERNEL_AVX2 int transformTrianglesAVX2(const FacePositions &rest, const float* matrices, int count, FacePositions &posed) {
+		int blocks = count / 8 * 8;
+
+		for (int i = 0; i < blocks; i += 8) {
+			__m256i base = _mm256_slli_epi32(_mm256_loadu_si256((const __m256i*)&rest.triangleFace[i]), 4);
+
+			__m256 m[12];
+			for (int column = 0; column < 4; column++) {
+				for (int row = 0; row < 3; row++) {
+					m[column * 3 + row] = _mm256_i32gather_ps(matrices, _mm256_add_epi32(base, _mm256_set1_epi32(column * 4 + row)), 4);
+				}
+			}
+
+			transformCornerAVX2(m, &rest.ax[i], &rest.ay[i], &rest.az[i], &posed.ax[i], &posed.ay[i], &posed.az[i]);
+			transformCornerAVX2(m, &rest.bx[i], &rest.by[i], &rest.bz[i], &posed.bx[i], &posed.by[i], &posed.bz[i]);
+			transformCornerAVX2(m, &rest.cx[i], &rest.cy[i], &rest.cz[i], &posed.cx[i], &posed.cy[i], &posed.cz[i]);
+		}
+
+		return blocks;
+	}
+
+	static KERNEL_AVX2 void transformCornerAVX2(const __m256* m, const float* x, const float* y, const float* z, float* outX, float* outY, float* outZ) {
+		__m256 px = _mm256_loadu_ps(x), py = _mm256_loadu_ps(y), pz = _mm256_loadu_ps(z);
+
+		for (int row = 0; row < 3; row++) {
+			__m256 value = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m[row], px), _mm256_mul_ps(m[3 + row], py)), _mm256_add_ps(_mm256_mul_ps(m[6 + row], pz), m[9 + row]));
+
+			_mm256_storeu_ps(row == 0 ? outX : (row == 1 ? outY : outZ), value);
+		}
+	}
+
+	// 4 triangles at a time (SSE has no gather so the matrix entries are loaded one lane at a time)
+	static int transformTrianglesSSE(const FacePositions &rest, const float* matrices, int count, FacePositions &posed) {
+		int blocks = count / 4 * 4;
+
+		for (int i = 0; i < blocks; i += 4) {
+			const float* lane0 = matrices + rest.triangleFace[i] * 16;
+			const float* lane1 = matrices + rest.triangleFace[i + 1] * 16;
+			const float* lane2 = matrices + rest.triangleFace[i + 2] * 16;
+			const float* lane3 = matrices + rest.triangleFace[i + 3] * 16;
+
+			__m128 m[12];
+			for (int column = 0; column < 4; column++) {
+				for (int row = 0; row < 3; row++) {
+					int k = column * 4 + row;
+					m[column * 3 + row] = _mm_set_ps(lane3[k], lane2[k], lane1[k], lane0[k]);
+				}
+			}
+
+			transformCornerSSE(m, &rest.ax[i], &rest.ay[i], &rest.az[i], &posed.ax[i], &posed.ay[i], &posed.az[i]);
+			transformCornerSSE(m, &rest.bx[i], &rest.by[i], &rest.bz[i], &posed.bx[i], &posed.by[i], &posed.bz[i]);
+			transformCornerSSE(m, &rest.cx[i], &rest.cy[i], &rest.cz[i], &posed.cx[i], &posed.cy[i], &posed.cz[i]);
+		}
+
+		return blocks;
+	}
+
+	static void transformCornerSSE(const __m128* m, const float* x, const float* y, const float* z, float* outX, float* outY, float* outZ) {
+		__m128 px = _mm_loadu_ps(x), py = _mm_loadu_ps(y), pz = _mm_loadu_ps(z);
+
+		for (int row = 0; row < 3; row++) {
+			__m128 value = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m[row], px), _mm_mul_ps(m[3 + row], py)), _mm_add_ps(_mm_mul_ps(m[6 + row], pz), m[9 + row]));
+
+			_mm_storeu_ps(row == 0 ? outX : (row == 1 ? outY : outZ), value);
+		}
+	}
+};
+
+#endif
@@ -144,6 +144,52 @@ public:
 		return node;
 	}
 
+	// makes a new child node without searching the graph for existing data first
+	// only use when the caller already guarantees the data is unique (eg: building a tree from an index based solution)
+	struct Node* appendNode(Node* root, T* data) {
+		Node* node = new Node();
+
+		node->id = size++;
+		node->data = data;
+
+		node->graph = this;
+
+		root->connections.push_back(node);
+
+		return node;
+	}
+
+	// free every node reachable from the root (node ids are unique within a graph, so each one is freed once even with two way connections)
+	// the graph is left empty, call this before deleting a graph made with new (assigning graphs shares their nodes, so there is no destructor)
+	void deleteNodes() {
+		vector<bool> visited(size, false);
+		vector<Node*> stack;
+
+		if (rootNode != nullptr) {
+			visited[rootNode->id] = true;
+			stack.push_back(rootNode);
+		}
+
+		while (!stack.empty()) {
+			Node* node = stack.back();
+			stack.pop_back();
+
+			for (int i = 0; i < node->connections.size(); i++) {
+				Node* next = node->connections[i];
+
+				if (!visited[next->id]) {
+					visited[next->id] = true;
+					stack.push_back(next);
+				}
+			}
+
+			delete node;
+		}
+
+		size = 0;
+		rootNode = nullptr;
+	}
+
 	// You must initialize with the first Node data
 	Graph() {
 		size = 0;
@@ -0,0 +1,258 @@
+#ifndef HINGEEDITOR_H
+#define HINGEEDITOR_H
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <cfloat>
+#include <set>
+#include <utility>
+
+#include "DynamicAABBTree.h"
+#include "FaceAdjacency.h"
+#include "NetValidation.h"
+#include "OrientedBounds.h"
+
+// Cut and fold individual hinges of an existing unfold tree.
+// The flat layout of every face is cached, so an edit only re-flattens the subtree that moved to a new parent
+// and only checks that subtree against the rest of the net (pairs inside the subtree or inside the rest can not change).
+// The face bounds live in a dynamic AABB tree next to the unfold, so the moved faces are updated in place instead of rebuilding the overlap index.
+class HingeEditor {
+public:
+	HingeEditor(const FaceAdjacency &adjacency, const UnfoldTree &tree) : adjacency(adjacency) {
+		this->tree = tree;
+
+		int n = adjacency.size();
+		transforms = vector<glm::mat4>(n, glm::mat4(1.0f));
+		triangles = vector<vector<glm::vec2>>(n);
+		faceMin = vector<glm::vec2>(n, glm::vec2(FLT_MAX));
+		faceMax = vector<glm::vec2>(n, glm::vec2(-FLT_MAX));
+
+		NetValidation::rootPlane(adjacency, tree.root, origin, u, v);
+
+		// the margin is relative to the whole model so it stays the same after every edit
+		margin = glm::length(adjacency.restMax - adjacency.restMin) * 0.0001f;
+
+		relayout(tree.root);
+
+		proxies = vector<int>(n, -1);
+		for (int i = 0; i < n; i++) {
+			if (tree.contains(i)) {
+				proxies[i] = boxes.insert(faceMin[i], faceMax[i], i);
+			}
+		}
+
+		vector<bool> everyFace(n, true);
+		checkOverlaps(everyFace, true);
+	}
+
+	const UnfoldTree &getTree() const {
+		return tree;
+	}
+
+	// pairs of faces (lower index first) that overlap in the flat net
+	const set<pair<int, int>> &getOverlaps() const {
+		return overlaps;
+	}
+
+	// rectangle around the flat net that fits the largest into a box of the given size (the same as Unfold::findUnfoldRectangle)
+	// built from the cached flat triangles, so the net is not laid out again
+	OrientedBounds::Rectangle getRectangle(glm::vec2 bounds) const {
+		// the triangles are relative to the root centroid, NetLayout measures from the origin of the shape
+		glm::vec2 offset = glm::vec2(glm::dot(origin, u), glm::dot(origin, v));
+
+		vector<glm::vec2> points;
+		for (int i = 0; i < triangles.size(); i++) {
+			if (tree.contains(i)) {
+				for (int j = 0; j < triangles[i].size(); j++) {
+					points.push_back(triangles[i][j] + offset);
+				}
+			}
+		}
+
+		return OrientedBounds::bestFit(OrientedBounds::convexHull(points), bounds);
+	}
+
+	// true if the two faces are joined by a hinge in the tree
+	bool isFolded(int a, int b) const {
+		return tree.parent[a] == b || tree.parent[b] == a;
+	}
+
+	// returns false if the hinge does not exist, is already in that state or can not be cut without splitting the net
+	bool setFolded(int a, int b, bool folded) {
+		if (a == b || a < 0 || b < 0 || a >= adjacency.size() || b >= adjacency.size()) {
+			return false;
+		}
+
+		if (adjacency.findEdge(a, b) == -1 || adjacency.findEdge(b, a) == -1 || isFolded(a, b) == folded) {
+			return false;
+		}
+
+		int moved = folded ? fold(a, b) : cut(a, b);
+		if (moved == -1) {
+			return false;
+		}
+
+		vector<int> subtree = tree.order(moved);
+
+		relayout(moved);
+
+		vector<bool> inSubtree(adjacency.size(), false);
+		for (int i = 0; i < subtree.size(); i++) {
+			inSubtree[subtree[i]] = true;
+
+			// a face that was not in the initial tree joins the overlap index when it is first attached
+			if (proxies[subtree[i]] == -1) {
+				proxies[subtree[i]] = boxes.insert(faceMin[subtree[i]], faceMax[subtree[i]], subtree[i]);
+			}
+			else {
+				boxes.update(proxies[subtree[i]], faceMin[subtree[i]], faceMax[subtree[i]]);
+			}
+		}
+		checkOverlaps(inSubtree, false);
+
+		return true;
+	}
+
+	bool toggle(int a, int b) {
+		return setFolded(a, b, !isFolded(a, b));
+	}
+
+private:
+	const FaceAdjacency &adjacency;
+	UnfoldTree tree;
+
+	vector<glm::mat4> transforms;
+
+	// flat triangles and bounds on the root plane (used for overlap and for fitting the net to the table)
+	vector<vector<glm::vec2>> triangles;
+	vector<glm::vec2> faceMin;
+	vector<glm::vec2> faceMax;
+
+	set<pair<int, int>> overlaps;
+
+	// flat bounds of every face (proxies[i] is the leaf of face i)
+	DynamicAABBTree<glm::vec2> boxes;
+	vector<int> proxies;
+
+	glm::vec3 origin, u, v;
+	float margin;
+
+	// attach the cut hinge between a and b, the face that moves loses the hinge to its old parent
+	// returns the face at the top of the subtree that moved
+	int fold(int a, int b) {
+		// the moving face must not be an ancestor of its new parent
+		int parentFace = a, child = b;
+		if (tree.isAncestor(b, a)) {
+			parentFace = b;
+			child = a;
+		}
+
+		tree.detach(child);
+		tree.attach(parentFace, child, adjacency.findEdge(parentFace, child));
+
+		return child;
+	}
+
+	// remove the folded hinge between a and b and hang the subtree that came loose off another of its cut hinges
+	// returns -1 if the hinge is the only connection between the two parts of the net
+	int cut(int a, int b) {
+		int child = tree.parent[b] == a ? b : a;
+		int parentFace = tree.parent[child];
+
+		vector<int> subtree = tree.order(child);
+		vector<bool> inSubtree(adjacency.size(), false);
+		for (int i = 0; i < subtree.size(); i++) {
+			inSubtree[subtree[i]] = true;
+		}
+
+		// the first face (closest to the hinge being cut) with a hinge to the rest of the net becomes the new top of the subtree
+		int top = -1, newParent = -1;
+		for (int i = 0; i < subtree.size() && top == -1; i++) {
+			for (int j = 0; j < adjacency.edges[subtree[i]].size(); j++) {
+				int neighbor = adjacency.edges[subtree[i]][j].neighbor;
+
+				if (inSubtree[neighbor] || (subtree[i] == child && neighbor == parentFace) || adjacency.findEdge(neighbor, subtree[i]) == -1) {
+					continue;
+				}
+
+				top = subtree[i];
+				newParent = neighbor;
+				break;
+			}
+		}
+
+		if (top == -1) {
+			return -1;
+		}
+
+		// path from the new top up to the old top of the subtree
+		vector<int> path;
+		for (int face = top; face != parentFace; face = tree.parent[face]) {
+			path.push_back(face);
+		}
+
+		for (int i = 0; i + 1 < path.size(); i++) {
+			if (adjacency.findEdge(path[i], path[i + 1]) == -1) {
+				return -1;
+			}
+		}
+
+		// flip the parents along the path so the subtree hangs from its new top
+		for (int i = 0; i < path.size(); i++) {
+			tree.detach(path[i]);
+		}
+		for (int i = 0; i + 1 < path.size(); i++) {
+			tree.attach(path[i], path[i + 1], adjacency.findEdge(path[i], path[i + 1]));
+		}
+		tree.attach(newParent, top, adjacency.findEdge(newParent, top));
+
+		return top;
+	}
+
+	// recompute the transforms and flat layout of a subtree
+	void relayout(int from) {
+		tree.updateTransforms(adjacency, transforms, from);
+
+		vector<int> subtree = tree.order(from);
+		for (int i = 0; i < subtree.size(); i++) {
+			int face = subtree[i];
+
+			NetValidation::flattenFace(adjacency, face, transforms[face], origin, u, v, triangles[face], faceMin[face], faceMax[face]);
+		}
+	}
+
+	// re-test the pairs with one face in the marked set and one outside of it (or every pair when all is true)
+	void checkOverlaps(const vector<bool> &marked, bool all) {
+		for (set<pair<int, int>>::iterator it = overlaps.begin(); it != overlaps.end();) {
+			if (all || marked[it->first] != marked[it->second]) {
+				it = overlaps.erase(it);
+			}
+			else {
+				it++;
+			}
+		}
+
+		for (int a = 0; a < adjacency.size(); a++) {
+			if (!marked[a] || proxies[a] == -1) {
+				continue;
+			}
+
+			boxes.query(faceMin[a], faceMax[a], margin, [&](int b) {
+				// every pair is seen from both sides when all faces are marked
+				if (all ? b <= a : marked[b]) {
+					return;
+				}
+
+				if (NetValidation::facesOverlap(triangles[a], triangles[b], margin)) {
+					overlaps.insert(make_pair(std::min(a, b), std::max(a, b)));
+				}
+			});
+		}
+	}
+};
+
+#endif
@@ -80,6 +80,9 @@ public:
 	// backup data
 	vector<Vertex> backupVertices;
 
+	// rigid transform of the whole mesh, applied in the vertex shader so the vertex buffer keeps the rest positions
+	glm::mat4 pose;
+
 	Mesh(QOpenGLFunctions_3_3_Core **f, vector<Vertex> vertices, vector<unsigned int> indices, vector<Texture> textures, vector<Material> materials, int samples)
 	{
 		this->f = f;
@@ -92,6 +95,8 @@ public:
 
 		this->backupVertices = vertices;
 
+		this->pose = glm::mat4(1.0f);
+
 		//set the vertex buffers and its attribute pointers.
 		setupMesh();
 	}
@@ -107,6 +112,8 @@ public:
 		shader.setBool("hasNormalTex", false);
 		shader.setBool("hasHeightTex", false);
 
+		shader.setMat4("pose", pose);
+
 		//bind textures
 		if (textures.size() != 0) {
 			unsigned int diffuseNr = 1;
@@ -183,10 +190,9 @@ public:
 		(*f)->glBindVertexArray(0);
 	}
 
-	// reset the mesh and also recalculate the normals
+	// upload the vertices again after the rest pose changed
+	// the normals are turned with the vertices (see Shape::levelBase) and the animation pose turns them in the vertex shader, so they are never summed up again
 	void rebuild() {
-		recompileNormals();
-
 		//clearBuffers();
 
 		//setupMesh();
@@ -202,7 +208,24 @@ public:
 
 		total /= vertices.size();
 
-		return total;
+		return glm::vec3(pose * glm::vec4(total, 1.0f));
+	}
+
+	// position of a vertex with the pose applied
+	glm::vec3 getPosedPosition(int index) {
+		return glm::vec3(pose * glm::vec4(vertices[index].Position, 1.0f));
+	}
+
+	// give every vertex the normal of the whole face (flat shading), done once when the face is registered
+	void setFlatNormals() {
+		// getNormal is posed, turn it back to the rest pose
+		glm::vec3 newNormal = glm::mat3(glm::transpose(pose)) * getNormal();
+
+		for (int i = 0; i < indices.size(); i+=3) {
+			vertices[indices[i]].Normal = newNormal;
+			vertices[indices[i+1]].Normal = newNormal;
+			vertices[indices[i+2]].Normal = newNormal;
+		}
 	}
 
 	// returns the normal to the shape
@@ -215,7 +238,7 @@ public:
 			normalSum += newNormal;
 		}
 
-		return normalSum * (1.0f / (indices.size() / 3));
+		return glm::mat3(pose) * (normalSum * (1.0f / (indices.size() / 3)));
 	}
 
 private:
@@ -276,16 +299,6 @@ private:
 		(*f)->glBindVertexArray(0);
 	}
 
-	void recompileNormals() {
-		glm::vec3 newNormal = getNormal();
-
-		for (int i = 0; i < indices.size(); i+=3) {
-			vertices[indices[i]].Normal = newNormal;
-			vertices[indices[i+1]].Normal = newNormal;
-			vertices[indices[i+2]].Normal = newNormal;
-		}
-	}
-
 	void printVertices() {
 		std::cout << "Vertices: " << std::endl;
 		for (int i = 0; i < vertices.size(); i++) {
@@ -21,6 +21,7 @@
 
 #include "Mesh.h"
 #include "Camera.h"
+#include "Predicates.h"
 
 #include <vector>
 #include <map>
@@ -491,35 +492,28 @@ private:
 		return "";
 	}
 
-	glm::vec4 getPlane(vector<Vertex> vert) {
-		float a1 = vert[1].Position.x - vert[0].Position.x;
-		float b1 = vert[1].Position.y - vert[0].Position.y;
-		float c1 = vert[1].Position.z - vert[0].Position.z;
-		float a2 = vert[2].Position.x - vert[0].Position.x;
-		float b2 = vert[2].Position.y - vert[0].Position.y;
-		float c2 = vert[2].Position.z - vert[0].Position.z;
-		float a = b1 * c2 - b2 * c1;
-		float b = a2 * c1 - a1 * c2;
-		float c = a1 * b2 - b1 * a2;
-		float d = (-a * vert[0].Position.x - b * vert[0].Position.y - c * vert[0].Position.z);
-
-		return glm::vec4(a, b, c, d);
-	}
-
+	// two triangles belong to the same face when they face the same way and the corners of each lie in the plane of the other
+	// the distance allowed from a plane is relative to the size of the two triangles, so it holds for huge models as well as finely tessellated ones
 	bool tangantFace(vector<Vertex> vertices1, vector<Vertex> vertices2) {
-		glm::vec4 plane1 = getPlane(vertices1);
-		glm::vec4 plane2 = getPlane(vertices2);
+		const double margin = 0.0001;
 
-		plane1 = glm::vec4(glm::normalize(plane1));
-		plane2 = glm::vec4(glm::normalize(plane2));
+		glm::vec3 a1 = vertices1[0].Position, b1 = vertices1[1].Position, c1 = vertices1[2].Position;
+		glm::vec3 a2 = vertices2[0].Position, b2 = vertices2[1].Position, c2 = vertices2[2].Position;
 
-		//std::cout << glm::distance(plane1, plane2) << std::endl;
-		if (glm::distance(plane1, plane2) <= 0.0001f) {
-			//std::cout << "here" << std::endl;
-			return true;
+		glm::dvec3 normal1 = glm::cross(glm::dvec3(b1) - glm::dvec3(a1), glm::dvec3(c1) - glm::dvec3(a1));
+		glm::dvec3 normal2 = glm::cross(glm::dvec3(b2) - glm::dvec3(a2), glm::dvec3(c2) - glm::dvec3(a2));
+
+		// also rules out degenerate triangles (no normal)
+		if (glm::dot(normal1, normal2) <= 0) {
+			return false;
 		}
 
-		return false;
+		glm::vec3 min = glm::min(glm::min(glm::min(a1, b1), glm::min(c1, a2)), glm::min(b2, c2));
+		glm::vec3 max = glm::max(glm::max(glm::max(a1, b1), glm::max(c1, a2)), glm::max(b2, c2));
+		double distance = margin * glm::length(glm::dvec3(max) - glm::dvec3(min));
+
+		return Predicates::coplanar(a1, b1, c1, a2, distance) && Predicates::coplanar(a1, b1, c1, b2, distance) && Predicates::coplanar(a1, b1, c1, c2, distance) &&
+			Predicates::coplanar(a2, b2, c2, a1, distance) && Predicates::coplanar(a2, b2, c2, b1, distance) && Predicates::coplanar(a2, b2, c2, c1, distance);
 	}
 };
 
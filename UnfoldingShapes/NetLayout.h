@@ -0,0 +1,172 @@
+#ifndef NETLAYOUT_H
+#define NETLAYOUT_H
+
+#include <glm/glm.hpp>
+
+#include <vector>
+#include <cfloat>
+
+#include "FaceAdjacency.h"
+#include "GeometryKernels.h"
+
+using namespace std;
+
+// 2D position of every vertex of an unfold laid flat on the plane of its root face.
+// Each face gets a rigid 2D frame that is chained from its parent's frame across the hinge they share,
+// so the net is found from the rest positions alone without rotating (or even touching) the mesh vertices.
+// The axes of the plane follow the world x and z axes, so for a base resting on the table the coordinates are the x and z of the shape.
+class NetLayout {
+public:
+	// per face, the 2D position of each rest vertex (empty for faces that are not part of the tree)
+	vector<vector<glm::vec2>> positions;
+
+	// bounds of every laid out vertex
+	glm::vec2 min;
+	glm::vec2 max;
+
+	NetLayout() {
+		min = glm::vec2(0);
+		max = glm::vec2(0);
+	}
+
+	NetLayout(const FaceAdjacency &adjacency, const UnfoldTree &tree) {
+		compute(adjacency, tree);
+	}
+
+	void compute(const FaceAdjacency &adjacency, const UnfoldTree &tree) {
+		positions = vector<vector<glm::vec2>>(adjacency.size());
+		min = glm::vec2(FLT_MAX);
+		max = glm::vec2(-FLT_MAX);
+
+		if (tree.root == -1) {
+			min = max = glm::vec2(0);
+			return;
+		}
+
+		vector<Frame> frames(adjacency.size());
+
+		vector<int> queue = tree.order();
+		for (int i = 0; i < queue.size(); i++) {
+			int face = queue[i];
+
+			if (face == tree.root) {
+				frames[face] = rootFrame(adjacency, face);
+			}
+			else {
+				frames[face] = childFrame(adjacency, tree, face, frames[tree.parent[face]]);
+			}
+
+			const vector<glm::vec3> &rest = adjacency.restPositions[face];
+			positions[face].resize(rest.size());
+
+			for (int j = 0; j < rest.size(); j++) {
+				positions[face][j] = frames[face].apply(rest[j]);
+			}
+
+			if (!rest.empty()) {
+				glm::vec2 faceMin, faceMax;
+				GeometryKernels::bounds(&positions[face][0], rest.size(), faceMin, faceMax);
+
+				min = glm::min(min, faceMin);
+				max = glm::max(max, faceMax);
+			}
+		}
+	}
+
+	bool contains(int face) const {
+		return !positions[face].empty();
+	}
+
+	// the 2D corners (3 per triangle) of one face
+	void faceTriangles(const FaceAdjacency &adjacency, int face, vector<glm::vec2> &triangles) const {
+		triangles.resize(adjacency.indices[face].size());
+
+		for (int i = 0; i < adjacency.indices[face].size(); i++) {
+			triangles[i] = positions[face][adjacency.indices[face][i]];
+		}
+	}
+
+	// in plane axes of a face that follow the world x and z axes as closely as possible
+	static void rootAxes(const FaceAdjacency &adjacency, int root, glm::vec3 &u, glm::vec3 &v) {
+		glm::vec3 normal = adjacency.normals[root];
+
+		u = glm::vec3(1, 0, 0) - normal * normal.x;
+		if (glm::length(u) < 0.001f) {
+			u = glm::vec3(0, 0, 1) - normal * normal.z;
+		}
+		u = glm::normalize(u);
+		v = glm::cross(normal, u);
+	}
+
+private:
+	// rigid map from the plane of a face to the net:
+	// a point at (a, b) along the 3D axes (measured from the 3D origin) lands at origin + a * x + b * y
+	struct Frame {
+		glm::vec3 restOrigin;
+		glm::vec3 restA, restB;
+
+		glm::vec2 origin;
+		glm::vec2 x, y;
+
+		glm::vec2 apply(glm::vec3 point) const {
+			glm::vec3 offset = point - restOrigin;
+			return origin + x * glm::dot(offset, restA) + y * glm::dot(offset, restB);
+		}
+
+		// direction in the plane of the face to a direction in the net
+		glm::vec2 applyDirection(glm::vec3 direction) const {
+			return x * glm::dot(direction, restA) + y * glm::dot(direction, restB);
+		}
+	};
+
+	static Frame rootFrame(const FaceAdjacency &adjacency, int root) {
+		Frame frame;
+
+		frame.restOrigin = glm::vec3(0);
+		rootAxes(adjacency, root, frame.restA, frame.restB);
+
+		frame.origin = glm::vec2(0);
+		frame.x = glm::vec2(1, 0);
+		frame.y = glm::vec2(0, 1);
+
+		return frame;
+	}
+
+	// the child keeps the hinge in the same place as its parent and lies flat on the other side of it
+	static Frame childFrame(const FaceAdjacency &adjacency, const UnfoldTree &tree, int face, const Frame &parentFrame) {
+		int parent = tree.parent[face];
+		const FaceAdjacency::Edge &edge = adjacency.edges[parent][tree.parentEdge[face]];
+
+		glm::vec3 line = glm::normalize(edge.line);
+
+		Frame frame;
+		frame.restOrigin = edge.point;
+		frame.restA = line;
+		frame.restB = awayFromHinge(adjacency, face, edge.point, line);
+
+		frame.origin = parentFrame.apply(edge.point);
+		frame.x = glm::normalize(parentFrame.applyDirection(line));
+
+		// the side of the hinge the parent covers in the net, the child goes on the other side
+		glm::vec2 parentSide = parentFrame.applyDirection(awayFromHinge(adjacency, parent, edge.point, line));
+		glm::vec2 perpendicular(-frame.x.y, frame.x.x);
+
+		frame.y = glm::dot(perpendicular, parentSide) > 0 ? -perpendicular : perpendicular;
+
+		return frame;
+	}
+
+	// unit direction in the plane of the face, at a right angle to the hinge, pointing into the face
+	static glm::vec3 awayFromHinge(const FaceAdjacency &adjacency, int face, glm::vec3 point, glm::vec3 line) {
+		glm::vec3 toCenter = adjacency.centroids[face] - point;
+		glm::vec3 away = toCenter - line * glm::dot(toCenter, line);
+
+		if (glm::length(away) < 0.000001f) {
+			away = glm::cross(adjacency.normals[face], line);
+		}
+
+		return glm::normalize(away);
+	}
+};
+
+#endif
@@ -0,0 +1,217 @@
+#ifndef NETMETRICS_H
+#define NETMETRICS_H
+
+#include <glm/glm.hpp>
+
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <utility>
+
+#include "FaceAdjacency.h"
+#include "NetLayout.h"
+#include "NetValidation.h"
+#include "OrientedBounds.h"
+
+// Measures the quality of a flat net without drawing it, so unfold patterns can be compared by the UI and by batch runs alike.
+// The net is laid out once and the same layout is used for the overlap search, the per face sums and the rectangle around it.
+static class NetMetrics {
+public:
+	struct Result {
+		// total length of the hinges that are cut (every shared edge that is not folded in the tree)
+		float cutLength;
+
+		// length of the outline of the flat net
+		float perimeter;
+
+		// area of the faces in the net and of the (turned) rectangle around it on the root plane, the same one the net is placed with
+		float netArea;
+		float boundsArea;
+
+		// pairs of overlapping faces (see NetValidation)
+		vector<pair<int, int>> overlaps;
+
+		// most hinges between the root and any face
+		int maxDepth;
+
+		// faces in the tree
+		int faceCount;
+
+		Result() {
+			cutLength = 0.0f;
+			perimeter = 0.0f;
+			netArea = 0.0f;
+			boundsArea = 0.0f;
+			maxDepth = 0;
+			faceCount = 0;
+		}
+
+		// share of the rectangle covered by faces (1 for a net that fills it)
+		float fillRatio() const {
+			return boundsArea > 0.0f ? netArea / boundsArea : 0.0f;
+		}
+
+		int overlapCount() const {
+			return overlaps.size();
+		}
+
+		void print() const {
+			std::cout << "Faces: " << faceCount << ", cut length: " << cutLength << ", perimeter: " << perimeter << ", fill ratio: " << fillRatio()
+				<< ", overlaps: " << overlapCount() << ", max depth: " << maxDepth << std::endl;
+		}
+	};
+
+	// bounds is the size of the box the net is placed in (see Unfold::findUnfoldRectangle), the rectangle around the net
+	// is then turned the same way as when it is placed; without a box the smallest area rectangle is used
+	static Result measure(const FaceAdjacency &adjacency, const UnfoldTree &tree, glm::vec2 bounds = glm::vec2(0)) {
+		Result result;
+
+		if (tree.root == -1) {
+			return result;
+		}
+
+		NetLayout layout(adjacency, tree);
+
+		vector<vector<glm::vec2>> triangles(adjacency.size());
+		vector<glm::vec2> points;
+		for (int i = 0; i < adjacency.size(); i++) {
+			if (layout.contains(i)) {
+				layout.faceTriangles(adjacency, i, triangles[i]);
+				points.insert(points.end(), layout.positions[i].begin(), layout.positions[i].end());
+			}
+		}
+
+		result.overlaps = NetValidation::findOverlaps(triangles, NetValidation::getMargin(layout.min, layout.max));
+
+		// folded hinges are inside the net, every other outer edge of a face is part of the outline
+		Sums total;
+		for (int face = 0; face < adjacency.size(); face++) {
+			measureFace(adjacency, tree, face, total);
+		}
+
+		vector<glm::vec2> hull = OrientedBounds::convexHull(points);
+		OrientedBounds::Rectangle rectangle = bounds.x > 0 && bounds.y > 0 ? OrientedBounds::bestFit(hull, bounds) : OrientedBounds::minimumArea(hull);
+
+		result.cutLength = total.cutLength;
+		result.perimeter = total.outlineLength - 2.0f * total.foldLength;
+		result.netArea = total.area;
+		result.boundsArea = rectangle.area();
+		result.maxDepth = maxDepth(tree);
+		result.faceCount = total.faces;
+
+		return result;
+	}
+
+	// number of hinges between the root and the deepest face
+	static int maxDepth(const UnfoldTree &tree) {
+		if (tree.root == -1) {
+			return 0;
+		}
+
+		vector<int> depth(tree.size(), 0);
+		int deepest = 0;
+
+		vector<int> queue = tree.order();
+		for (int i = 1; i < queue.size(); i++) {
+			depth[queue[i]] = depth[tree.parent[queue[i]]] + 1;
+			deepest = std::max(deepest, depth[queue[i]]);
+		}
+
+		return deepest;
+	}
+
+	// length of the outer edges of a face (edges of its triangles that no other triangle of the face shares)
+	static float outlineLength(const FaceAdjacency &adjacency, int face) {
+		const vector<glm::vec3> &rest = adjacency.restPositions[face];
+		const vector<unsigned int> &indices = adjacency.indices[face];
+
+		// the faces may not share vertices between their triangles, so the edges are matched by position
+		vector<pair<glm::vec3, glm::vec3>> sides;
+		for (int i = 0; i + 2 < indices.size(); i += 3) {
+			for (int j = 0; j < 3; j++) {
+				glm::vec3 a = rest[indices[i + j]];
+				glm::vec3 b = rest[indices[i + (j + 1) % 3]];
+
+				sides.push_back(lessThan(a, b) ? make_pair(a, b) : make_pair(b, a));
+			}
+		}
+
+		std::sort(sides.begin(), sides.end(), [](const pair<glm::vec3, glm::vec3> &a, const pair<glm::vec3, glm::vec3> &b) {
+			return lessThan(a.first, b.first) || (a.first == b.first && lessThan(a.second, b.second));
+		});
+
+		float length = 0.0f;
+		for (int i = 0; i < sides.size(); ) {
+			int end = i + 1;
+			while (end < sides.size() && sides[end] == sides[i]) {
+				end++;
+			}
+
+			if (end - i == 1) {
+				length += glm::distance(sides[i].first, sides[i].second);
+			}
+
+			i = end;
+		}
+
+		return length;
+	}
+
+private:
+	struct Sums {
+		float cutLength;
+		float foldLength;
+		float outlineLength;
+		float area;
+		int faces;
+
+		Sums() {
+			cutLength = 0.0f;
+			foldLength = 0.0f;
+			outlineLength = 0.0f;
+			area = 0.0f;
+			faces = 0;
+		}
+	};
+
+	static void measureFace(const FaceAdjacency &adjacency, const UnfoldTree &tree, int face, Sums &sums) {
+		if (!tree.contains(face)) {
+			return;
+		}
+
+		sums.faces++;
+		sums.area += adjacency.areas[face];
+		sums.outlineLength += outlineLength(adjacency, face);
+
+		// every hinge is stored on both faces, the face with the lower index counts it
+		for (int i = 0; i < adjacency.edges[face].size(); i++) {
+			const FaceAdjacency::Edge &edge = adjacency.edges[face][i];
+
+			if (edge.neighbor < face || !tree.contains(edge.neighbor)) {
+				continue;
+			}
+
+			float length = glm::distance(edge.p1, edge.p2);
+
+			if (tree.parent[edge.neighbor] == face || tree.parent[face] == edge.neighbor) {
+				sums.foldLength += length;
+			}
+			else {
+				sums.cutLength += length;
+			}
+		}
+	}
+
+	static bool lessThan(glm::vec3 a, glm::vec3 b) {
+		if (a.x != b.x) {
+			return a.x < b.x;
+		}
+		if (a.y != b.y) {
+			return a.y < b.y;
+		}
+
+		return a.z < b.z;
+	}
+};
+
+#endif
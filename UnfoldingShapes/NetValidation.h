@@ -0,0 +1,357 @@
+#ifndef NETVALIDATION_H
+#define NETVALIDATION_H
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <cfloat>
+#include <utility>
+
+#include "FaceAdjacency.h"
+#include "NetLayout.h"
+#include "Predicates.h"
+
+// Flattens an unfold onto the plane of its root face and finds the pairs of faces that overlap.
+// All triangles go into a bounding volume hierarchy that is tested against itself, so only triangles with overlapping bounds are compared,
+// and the triangle test itself is made of exact orientation tests.
+static class NetValidation {
+public:
+	struct Result {
+		// pairs of overlapping faces (lower index first, sorted)
+		vector<pair<int, int>> overlaps;
+
+		// bounds of the net on the root plane
+		glm::vec2 min;
+		glm::vec2 max;
+
+		bool isValid() const {
+			return overlaps.empty();
+		}
+	};
+
+	static Result validate(const FaceAdjacency &adjacency, const UnfoldTree &tree) {
+		Result result;
+
+		vector<vector<glm::vec2>> triangles;
+		flatten(adjacency, tree, triangles, result.min, result.max);
+
+		result.overlaps = findOverlaps(triangles, getMargin(result.min, result.max));
+
+		return result;
+	}
+
+	// how far faces may reach into each other before they count as overlapping
+	// this absorbs the rounding of the hinge rotations, so faces that share an edge or a corner are not reported
+	static float getMargin(glm::vec2 min, glm::vec2 max) {
+		return glm::length(max - min) * 0.0001f;
+	}
+
+	// 2D axes on the plane of the root face (centered on the root)
+	// the axes follow the world x and z axes as closely as possible so a level base gives table coordinates
+	static void rootPlane(const FaceAdjacency &adjacency, int root, glm::vec3 &origin, glm::vec3 &u, glm::vec3 &v) {
+		origin = adjacency.centroids[root];
+		NetLayout::rootAxes(adjacency, root, u, v);
+	}
+
+	// the 2D corners (3 per triangle) of one face moved by its transform and dropped onto the root plane
+	static void flattenFace(const FaceAdjacency &adjacency, int face, const glm::mat4 &transform, glm::vec3 origin, glm::vec3 u, glm::vec3 v, vector<glm::vec2> &triangles, glm::vec2 &min, glm::vec2 &max) {
+		triangles.clear();
+		min = glm::vec2(FLT_MAX);
+		max = glm::vec2(-FLT_MAX);
+
+		for (int i = 0; i < adjacency.indices[face].size(); i++) {
+			glm::vec3 pos = glm::vec3(transform * glm::vec4(adjacency.restPositions[face][adjacency.indices[face][i]], 1.0f)) - origin;
+			glm::vec2 flat = glm::vec2(glm::dot(pos, u), glm::dot(pos, v));
+
+			min = glm::min(min, flat);
+			max = glm::max(max, flat);
+
+			triangles.push_back(flat);
+		}
+	}
+
+	// fills triangles with the 2D corners (3 per triangle) of every face on the plane of the root face
+	static void flatten(const FaceAdjacency &adjacency, const UnfoldTree &tree, vector<vector<glm::vec2>> &triangles, glm::vec2 &min, glm::vec2 &max) {
+		NetLayout layout(adjacency, tree);
+
+		min = layout.min;
+		max = layout.max;
+
+		triangles = vector<vector<glm::vec2>>(adjacency.size());
+		for (int i = 0; i < adjacency.size(); i++) {
+			if (layout.contains(i)) {
+				layout.faceTriangles(adjacency, i, triangles[i]);
+			}
+		}
+	}
+
+	// every pair of faces whose triangles overlap by more than the margin (a margin of 0 reports any shared interior)
+	static vector<pair<int, int>> findOverlaps(const vector<vector<glm::vec2>> &triangles, float margin) {
+		Hierarchy hierarchy(triangles);
+
+		return hierarchy.selfOverlaps(margin);
+	}
+
+	static bool facesOverlap(const vector<glm::vec2> &a, const vector<glm::vec2> &b, float margin) {
+		for (int i = 0; i + 2 < a.size(); i += 3) {
+			for (int j = 0; j + 2 < b.size(); j += 3) {
+				if (trianglesOverlap(&a[i], &b[j], margin)) {
+					return true;
+				}
+			}
+		}
+
+		return false;
+	}
+
+	// separating axis test on the six edges with exact orientation signs
+	// corners closer than the margin to an edge count as lying on it, so triangles that only touch (like neighboring faces) do not overlap
+	static bool trianglesOverlap(const glm::vec2* a, const glm::vec2* b, float margin) {
+		return trianglesOverlap(a, Predicates::orient2d(a[0], a[1], a[2]), b, Predicates::orient2d(b[0], b[1], b[2]), margin);
+	}
+
+private:
+	static bool trianglesOverlap(const glm::vec2* a, int windingA, const glm::vec2* b, int windingB, float margin) {
+		// a triangle without area has no inside to overlap with
+		if (windingA == 0 || windingB == 0) {
+			return false;
+		}
+
+		return !separatedBy(a, windingA, b, margin) && !separatedBy(b, windingB, a, margin);
+	}
+
+	// true if one edge of the triangle has every corner of the other triangle on its outside (or on the edge)
+	static bool separatedBy(const glm::vec2* triangle, int winding, const glm::vec2* other, float margin) {
+		for (int i = 0; i < 3; i++) {
+			glm::vec2 start = triangle[i];
+			glm::vec2 end = triangle[(i + 1) % 3];
+
+			// the orientation is twice the area, so the band is the margin times the length of the edge
+			double tolerance = margin * glm::length(end - start);
+
+			bool separated = true;
+			for (int j = 0; j < 3 && separated; j++) {
+				if (Predicates::orient2d(start, end, other[j], tolerance) * winding > 0) {
+					separated = false;
+				}
+			}
+
+			if (separated) {
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	// bounding volume hierarchy over the triangles of every face
+	// the triangles are sorted along a Morton curve once, then every node splits its range in half
+	struct Hierarchy {
+		static const int leafSize = 4;
+
+		struct Node {
+			glm::vec2 min;
+			glm::vec2 max;
+
+			// children for inner nodes, a range of items for leaves (count is 0 for inner nodes)
+			int left, right;
+			int start, count;
+		};
+
+		// one item per triangle in curve order
+		vector<int> itemFace;
+		vector<const glm::vec2*> itemCorners;
+		vector<int> itemWinding;
+		vector<glm::vec2> itemMin;
+		vector<glm::vec2> itemMax;
+
+		vector<Node> nodes;
+
+		Hierarchy(const vector<vector<glm::vec2>> &triangles) {
+			vector<int> faces;
+			vector<const glm::vec2*> corners;
+			glm::vec2 min(FLT_MAX), max(-FLT_MAX);
+
+			for (int i = 0; i < triangles.size(); i++) {
+				for (int j = 0; j + 2 < triangles[i].size(); j += 3) {
+					faces.push_back(i);
+					corners.push_back(&triangles[i][j]);
+
+					min = glm::min(min, triangles[i][j]);
+					max = glm::max(max, triangles[i][j]);
+				}
+			}
+
+			if (faces.empty()) {
+				return;
+			}
+
+			// sort by the Morton code of the first corner so triangles next to each other in the list are close on the plane
+			glm::vec2 scale = 65535.0f / glm::max(max - min, glm::vec2(FLT_MIN));
+
+			vector<pair<unsigned int, int>> keys(faces.size());
+			for (int i = 0; i < faces.size(); i++) {
+				glm::vec2 cell = (corners[i][0] - min) * scale;
+				keys[i] = make_pair(interleave((unsigned int)cell.x) | (interleave((unsigned int)cell.y) << 1), i);
+			}
+			std::sort(keys.begin(), keys.end());
+
+			int count = faces.size();
+			itemFace.resize(count);
+			itemCorners.resize(count);
+			itemWinding.resize(count);
+			itemMin.resize(count);
+			itemMax.resize(count);
+
+			for (int i = 0; i < count; i++) {
+				const glm::vec2* triangle = corners[keys[i].second];
+
+				itemFace[i] = faces[keys[i].second];
+				itemCorners[i] = triangle;
+				itemWinding[i] = Predicates::orient2d(triangle[0], triangle[1], triangle[2]);
+				itemMin[i] = glm::min(triangle[0], glm::min(triangle[1], triangle[2]));
+				itemMax[i] = glm::max(triangle[0], glm::max(triangle[1], triangle[2]));
+			}
+
+			nodes.reserve(2 * (count / leafSize + 1));
+			build(0, count);
+		}
+
+		// spread the lower 16 bits of a value out to the even bits
+		static unsigned int interleave(unsigned int value) {
+			value &= 0x0000ffff;
+			value = (value | (value << 8)) & 0x00ff00ff;
+			value = (value | (value << 4)) & 0x0f0f0f0f;
+			value = (value | (value << 2)) & 0x33333333;
+			value = (value | (value << 1)) & 0x55555555;
+
+			return value;
+		}
+
+		int build(int start, int end) {
+			int index = nodes.size();
+			nodes.push_back(Node());
+
+			if (end - start <= leafSize) {
+				glm::vec2 min(FLT_MAX), max(-FLT_MAX);
+				for (int i = start; i < end; i++) {
+					min = glm::min(min, itemMin[i]);
+					max = glm::max(max, itemMax[i]);
+				}
+
+				nodes[index].min = min;
+				nodes[index].max = max;
+				nodes[index].left = nodes[index].right = -1;
+				nodes[index].start = start;
+				nodes[index].count = end - start;
+				return index;
+			}
+
+			int middle = (start + end) / 2;
+			int left = build(start, middle);
+			int right = build(middle, end);
+
+			nodes[index].min = glm::min(nodes[left].min, nodes[right].min);
+			nodes[index].max = glm::max(nodes[left].max, nodes[right].max);
+			nodes[index].left = left;
+			nodes[index].right = right;
+			nodes[index].start = start;
+			nodes[index].count = 0;
+
+			return index;
+		}
+
+		// test the hierarchy against itself, a node pair is only opened if the bounds overlap by more than the margin
+		vector<pair<int, int>> selfOverlaps(float margin) {
+			vector<pair<int, int>> pairs;
+
+			if (nodes.empty()) {
+				return pairs;
+			}
+
+			vector<pair<int, int>> stack;
+			stack.push_back(make_pair(0, 0));
+
+			while (!stack.empty()) {
+				int a = stack.back().first;
+				int b = stack.back().second;
+				stack.pop_back();
+
+				const Node &nodeA = nodes[a];
+				const Node &nodeB = nodes[b];
+
+				// a node against itself: both halves against themselves and against each other
+				if (a == b) {
+					if (nodeA.count > 0) {
+						for (int i = nodeA.start; i < nodeA.start + nodeA.count; i++) {
+							for (int j = i + 1; j < nodeA.start + nodeA.count; j++) {
+								testItems(i, j, margin, pairs);
+							}
+						}
+					}
+					else {
+						stack.push_back(make_pair(nodeA.left, nodeA.left));
+						stack.push_back(make_pair(nodeA.right, nodeA.right));
+						pushIfOverlapping(nodeA.left, nodeA.right, margin, stack);
+					}
+					continue;
+				}
+
+				if (nodeA.count > 0 && nodeB.count > 0) {
+					for (int i = nodeA.start; i < nodeA.start + nodeA.count; i++) {
+						for (int j = nodeB.start; j < nodeB.start + nodeB.count; j++) {
+							testItems(i, j, margin, pairs);
+						}
+					}
+				}
+				// open the larger node (or the only inner one)
+				else if (nodeB.count > 0 || (nodeA.count == 0 && area(nodeA) >= area(nodeB))) {
+					pushIfOverlapping(nodeA.left, b, margin, stack);
+					pushIfOverlapping(nodeA.right, b, margin, stack);
+				}
+				else {
+					pushIfOverlapping(a, nodeB.left, margin, stack);
+					pushIfOverlapping(a, nodeB.right, margin, stack);
+				}
+			}
+
+			std::sort(pairs.begin(), pairs.end());
+			pairs.erase(std::unique(pairs.begin(), pairs.end()), pairs.end());
+
+			return pairs;
+		}
+
+		void pushIfOverlapping(int a, int b, float margin, vector<pair<int, int>> &stack) {
+			if (boundsOverlap(nodes[a].min, nodes[a].max, nodes[b].min, nodes[b].max, margin)) {
+				stack.push_back(make_pair(a, b));
+			}
+		}
+
+		void testItems(int a, int b, float margin, vector<pair<int, int>> &pairs) {
+			int faceA = itemFace[a];
+			int faceB = itemFace[b];
+
+			if (faceA == faceB || !boundsOverlap(itemMin[a], itemMax[a], itemMin[b], itemMax[b], margin)) {
+				return;
+			}
+
+			if (trianglesOverlap(itemCorners[a], itemWinding[a], itemCorners[b], itemWinding[b], margin)) {
+				pairs.push_back(make_pair(std::min(faceA, faceB), std::max(faceA, faceB)));
+			}
+		}
+
+		static bool boundsOverlap(glm::vec2 minA, glm::vec2 maxA, glm::vec2 minB, glm::vec2 maxB, float margin) {
+			return minA.x < maxB.x - margin && minB.x < maxA.x - margin && minA.y < maxB.y - margin && minB.y < maxA.y - margin;
+		}
+
+		static float area(const Node &node) {
+			glm::vec2 size = node.max - node.min;
+			return size.x * size.y;
+		}
+	};
+};
+
+#endif
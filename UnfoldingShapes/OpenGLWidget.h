@@ -20,6 +20,7 @@
 #include "Asset.h"
 #include "Model.h"
 #include "Mesh.h"
+#include "ScenePicker.h"
 
 class OpenGLWidget : public QOpenGLWidget {
 public:
@@ -48,6 +49,9 @@ public:
 	// list of the physical models with all the transforms applied
 	std::vector<Asset*> scene;
 
+	// ray picking over the visible assets (updated on demand by pick)
+	ScenePicker picker;
+
 	// temp testing vars
 	unsigned int VAO;
 	unsigned int VBO;
@@ -148,13 +152,9 @@ public:
 
 				
 				// translate model
-				glm::mat4 model = glm::mat4(1.0f);
-				model = glm::translate(model, scene[i]->position);
-				model = glm::rotate(model, glm::radians(scene[i]->rotation.x), glm::vec3(1.0, 0.0, 0.0));
-				model = glm::rotate(model, glm::radians(scene[i]->rotation.y), glm::vec3(0.0, 1.0, 0.0));
-				model = glm::rotate(model, glm::radians(scene[i]->rotation.z), glm::vec3(0.0, 0.0, 1.0));
-				model = glm::scale(model, scene[i]->scale);	// it's a bit too big for our scene, so scale it down
+				glm::mat4 model = scene[i]->getModelMatrix();
 				shader.setMat4("model", model);
+				shader.setMat3("normalModel", glm::transpose(glm::inverse(glm::mat3(model))));
 
 				if (scene[i]->model != nullptr) {
 					scene[i]->model->Draw(shader, camera);
@@ -163,6 +163,17 @@ public:
 		}
 	}
 
+	// the visible asset mesh under a point of the widget (in pixels from the top left corner)
+	// the hierarchy is only brought up to date with the animation here, so frames without a click do not pay for it
+	bool pick(glm::vec2 screenPos, ScenePicker::Hit &hit) {
+		picker.update(scene);
+
+		glm::vec3 origin, direction;
+		ScenePicker::screenRay(camera, screenPos, glm::vec2(width(), height()), origin, direction);
+
+		return picker.pick(origin, direction, hit);
+	}
+
 	// set mouse event handling to update mouse struct
 	void mousePressEvent(QMouseEvent* event) {
 		/*
@@ -0,0 +1,228 @@
+#ifndef ORIENTEDBOUNDS_H
+#define ORIENTEDBOUNDS_H
+
+#include <glm/glm.hpp>
+#include <glm/gtc/constants.hpp>
+
+#include <vector>
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+#include "Predicates.h"
+
+using namespace std;
+
+// Rectangles around a set of 2D points that may be turned to any angle.
+// The points are reduced to their convex hull and rotating calipers walk every hull edge once,
+// since the smallest rectangle around a convex polygon always has one side on one of its edges.
+static class OrientedBounds {
+public:
+	struct Rectangle {
+		// direction of the first side (radians from the x axis)
+		float angle;
+
+		// bounds along the first side direction (x) and the direction a quarter turn counter clockwise from it (y)
+		glm::vec2 min;
+		glm::vec2 max;
+
+		Rectangle() {
+			angle = 0;
+			min = glm::vec2(0);
+			max = glm::vec2(0);
+		}
+
+		glm::vec2 size() const {
+			return max - min;
+		}
+
+		float area() const {
+			return (max.x - min.x) * (max.y - min.y);
+		}
+
+		// the same rectangle with its sides swapped
+		Rectangle quarterTurn() const {
+			Rectangle turned;
+			turned.angle = angle + glm::half_pi<float>();
+			turned.min = glm::vec2(min.y, -max.x);
+			turned.max = glm::vec2(max.y, -min.x);
+
+			return turned;
+		}
+	};
+
+	// counter clockwise convex hull without collinear points (Andrew's monotone chain)
+	static vector<glm::vec2> convexHull(vector<glm::vec2> points) {
+		std::sort(points.begin(), points.end(), [](glm::vec2 a, glm::vec2 b) {
+			return a.x < b.x || (a.x == b.x && a.y < b.y);
+		});
+		points.erase(std::unique(points.begin(), points.end()), points.end());
+
+		if (points.size() < 3) {
+			return points;
+		}
+
+		vector<glm::vec2> hull(2 * points.size());
+		int count = 0;
+
+		// lower chain
+		for (int i = 0; i < points.size(); i++) {
+			while (count >= 2 && Predicates::orient2d(hull[count - 2], hull[count - 1], points[i]) <= 0) {
+				count--;
+			}
+			hull[count++] = points[i];
+		}
+
+		// upper chain
+		int lower = count + 1;
+		for (int i = points.size() - 2; i >= 0; i--) {
+			while (count >= lower && Predicates::orient2d(hull[count - 2], hull[count - 1], points[i]) <= 0) {
+				count--;
+			}
+			hull[count++] = points[i];
+		}
+
+		// the first point was added again at the end
+		hull.resize(count - 1);
+
+		return hull;
+	}
+
+	// rectangle lined up with the x and z axes
+	static Rectangle axisAligned(const vector<glm::vec2> &points) {
+		Rectangle rectangle;
+
+		if (points.empty()) {
+			return rectangle;
+		}
+
+		rectangle.min = glm::vec2(FLT_MAX);
+		rectangle.max = glm::vec2(-FLT_MAX);
+		for (int i = 0; i < points.size(); i++) {
+			rectangle.min = glm::min(rectangle.min, points[i]);
+			rectangle.max = glm::max(rectangle.max, points[i]);
+		}
+
+		return rectangle;
+	}
+
+	// smallest area rectangle around a convex hull
+	static Rectangle minimumArea(const vector<glm::vec2> &hull) {
+		Rectangle best = axisAligned(hull);
+
+		forEachEdgeRectangle(hull, [&](const Rectangle &rectangle) {
+			if (rectangle.area() < best.area()) {
+				best = rectangle;
+			}
+		});
+
+		return best;
+	}
+
+	// the rectangle around a convex hull that can be scaled up the most while still fitting in an axis aligned box of the given size
+	// every hull edge is tried in both directions (along the width and along the height of the box) as well as no rotation at all
+	static Rectangle bestFit(const vector<glm::vec2> &hull, glm::vec2 bounds) {
+		Rectangle best = axisAligned(hull);
+		float bestScale = fitScale(best, bounds);
+
+		forEachEdgeRectangle(hull, [&](const Rectangle &rectangle) {
+			Rectangle options[2] = { rectangle, rectangle.quarterTurn() };
+
+			for (int i = 0; i < 2; i++) {
+				float scale = fitScale(options[i], bounds);
+
+				if (scale > bestScale) {
+					best = options[i];
+					bestScale = scale;
+				}
+			}
+		});
+
+		return best;
+	}
+
+	// how much the rectangle can be scaled up before it no longer fits in the box
+	static float fitScale(const Rectangle &rectangle, glm::vec2 bounds) {
+		glm::vec2 size = rectangle.size();
+
+		if (size.x <= 0 || size.y <= 0) {
+			return 0;
+		}
+
+		return std::min(bounds.x / size.x, bounds.y / size.y);
+	}
+
+private:
+	// call back with the rectangle that has a side on each hull edge
+	// the points furthest along the edge, furthest from it and furthest back only ever move forward around the hull, so the walk is linear
+	template <class F>
+	static void forEachEdgeRectangle(const vector<glm::vec2> &points, F callback) {
+		vector<glm::vec2> hull = mergeClosePoints(points);
+		int n = hull.size();
+
+		if (n < 3) {
+			return;
+		}
+
+		int front = 0, top = 0, back = 0;
+
+		for (int i = 0; i < n; i++) {
+			glm::vec2 along = glm::normalize(hull[(i + 1) % n] - hull[i]);
+			glm::vec2 across(-along.y, along.x);
+
+			// the hull is counter clockwise so the inside is on the left (across) of every edge
+			if (i == 0) {
+				front = 1;
+			}
+			front = advance(hull, front, along);
+			top = advance(hull, i == 0 ? front : top, across);
+			back = advance(hull, i == 0 ? top : back, -along);
+
+			Rectangle rectangle;
+			rectangle.angle = std::atan2(along.y, along.x);
+			rectangle.min = glm::vec2(glm::dot(hull[back], along), glm::dot(hull[i], across));
+			rectangle.max = glm::vec2(glm::dot(hull[front], along), glm::dot(hull[top], across));
+
+			callback(rectangle);
+		}
+	}
+
+	// drop hull points that only differ from the one before them by rounding
+	// (their edge has no usable direction, and a point that ties with its neighbour in a direction would stop the calipers early)
+	static vector<glm::vec2> mergeClosePoints(const vector<glm::vec2> &hull) {
+		Rectangle extent = axisAligned(hull);
+		float shortest = glm::length(extent.size()) * 1e-5f;
+
+		vector<glm::vec2> merged;
+		for (int i = 0; i < hull.size(); i++) {
+			if (merged.empty() || glm::length(hull[i] - merged.back()) > shortest) {
+				merged.push_back(hull[i]);
+			}
+		}
+
+		while (merged.size() > 1 && glm::length(merged.front() - merged.back()) <= shortest) {
+			merged.pop_back();
+		}
+
+		return merged;
+	}
+
+	// move forward around the hull while the next point is further in the direction
+	static int advance(const vector<glm::vec2> &hull, int index, glm::vec2 direction) {
+		int n = hull.size();
+
+		for (int steps = 0; steps < n; steps++) {
+			int next = (index + 1) % n;
+
+			if (glm::dot(hull[next], direction) <= glm::dot(hull[index], direction)) {
+				break;
+			}
+
+			index = next;
+		}
+
+		return index;
+	}
+};
+
+#endif
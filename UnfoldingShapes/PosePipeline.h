@@ -0,0 +1,228 @@
+#ifndef POSEPIPELINE_H
+#define POSEPIPELINE_H
+
+#include <glm/glm.hpp>
+
+#include <vector>
+#include <functional>
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+
+#include "WorkerPool.h"
+
+using namespace std;
+
+// Evaluates the per face transforms of the next frame on a worker thread while the current frame is drawn.
+// Every animation has a slot with two buffers: the worker fills the back buffer and swaps it to the front when it is done,
+// and the GUI thread takes the front buffer at its next update, so posing never waits on the evaluation of the frame after it.
+// The worker takes every queued frame at once and evaluates them as one batch on the shared WorkerPool, timing each job.
+// A job may only read data that nothing else changes while it runs (see UnfoldSchedule and AnimationTimeline snapshots).
+class PosePipeline {
+public:
+	// fills the transforms of one frame
+	typedef std::function<void(vector<glm::mat4>&)> Job;
+
+	// what a frame was requested for, handed back with the result so stale frames can be told apart
+	typedef unsigned long long Tag;
+
+	PosePipeline() {
+		stopping = false;
+		worker = std::thread(&PosePipeline::run, this);
+	}
+
+	~PosePipeline() {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stopping = true;
+		}
+		wake.notify_all();
+
+		worker.join();
+
+		for (int i = 0; i < frameSlots.size(); i++) {
+			delete frameSlots[i];
+		}
+	}
+
+	// the next frame of one slot
+	struct Request {
+		int slot;
+		Job job;
+		Tag tag;
+
+		Request(int slot, const Job &job, Tag tag) {
+			this->slot = slot;
+			this->job = job;
+			this->tag = tag;
+		}
+	};
+
+	// queue the next frame of every slot in the list together, so they are evaluated in the same batch
+	// (a job that has not started yet is replaced, only the newest frame matters)
+	void request(const vector<Request> &requests) {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+
+			for (int i = 0; i < requests.size(); i++) {
+				while (frameSlots.size() <= requests[i].slot) {
+					frameSlots.push_back(new Slot());
+				}
+
+				frameSlots[requests[i].slot]->job = requests[i].job;
+				frameSlots[requests[i].slot]->jobTag = requests[i].tag;
+			}
+		}
+		wake.notify_one();
+	}
+
+	// swap the newest finished frame of a slot into transforms, false if nothing finished since the last take
+	// cost is the milliseconds the job took
+	bool take(int slot, vector<glm::mat4> &transforms, Tag &tag, float &cost) {
+		std::lock_guard<std::mutex> lock(mutex);
+
+		if (slot >= frameSlots.size() || !frameSlots[slot]->fresh) {
+			return false;
+		}
+
+		transforms.swap(frameSlots[slot]->front);
+		tag = frameSlots[slot]->frontTag;
+		cost = frameSlots[slot]->frontCost;
+		frameSlots[slot]->fresh = false;
+
+		return true;
+	}
+
+	// run jobs on the shared WorkerPool (the calling thread helps), each one filling its own output
+	// costs receives the milliseconds each job took
+	// a job runs as a pool task, so the pose it evaluates stays on one thread (see UnfoldSchedule::evaluate)
+	static void runBatch(const vector<Job> &jobs, const vector<vector<glm::mat4>*> &outputs, vector<float> &costs) {
+		costs.resize(jobs.size());
+
+		WorkerPool::shared().run(jobs.size(), [&](int job) {
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+			jobs[job](*outputs[job]);
+
+			costs[job] = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+		});
+	}
+
+	// drop a queued frame and any finished one that was not taken yet (eg: the animation was changed)
+	// a frame that is being evaluated right now is dropped when it finishes
+	void cancel(int slot) {
+		std::lock_guard<std::mutex> lock(mutex);
+
+		if (slot < frameSlots.size()) {
+			frameSlots[slot]->job = nullptr;
+			frameSlots[slot]->fresh = false;
+			frameSlots[slot]->cancels++;
+		}
+	}
+
+private:
+	struct Slot {
+		Job job;
+		Tag jobTag;
+
+		// only the worker touches the back buffer (outside of the lock), the front buffer is swapped under the lock
+		vector<glm::mat4> back;
+		vector<glm::mat4> front;
+		Tag frontTag;
+		float frontCost;
+		bool fresh;
+
+		// number of cancels, a batch that sees it change while it runs throws its frame of this slot away
+		unsigned int cancels;
+
+		Slot() {
+			jobTag = 0;
+			frontTag = 0;
+			frontCost = 0.0f;
+			fresh = false;
+			cancels = 0;
+		}
+	};
+
+	// slots are never removed or moved, so the worker can fill a back buffer without holding the lock
+	vector<Slot*> frameSlots;
+
+	std::mutex mutex;
+	std::condition_variable wake;
+	bool stopping;
+
+	std::thread worker;
+
+	void run() {
+		std::unique_lock<std::mutex> lock(mutex);
+
+		vector<Slot*> batch;
+		vector<Job> jobs;
+		vector<Tag> tags;
+		vector<unsigned int> cancels;
+		vector<vector<glm::mat4>*> outputs;
+		vector<float> costs;
+
+		while (true) {
+			if (!hasJob()) {
+				if (stopping) {
+					return;
+				}
+
+				wake.wait(lock);
+				continue;
+			}
+
+			// every queued frame goes into the same batch
+			batch.clear();
+			jobs.clear();
+			tags.clear();
+			cancels.clear();
+			outputs.clear();
+
+			for (int i = 0; i < frameSlots.size(); i++) {
+				Slot* slot = frameSlots[i];
+
+				if (slot->job) {
+					batch.push_back(slot);
+					jobs.push_back(std::move(slot->job));
+					tags.push_back(slot->jobTag);
+					cancels.push_back(slot->cancels);
+					outputs.push_back(&slot->back);
+
+					slot->job = nullptr;
+				}
+			}
+
+			lock.unlock();
+			runBatch(jobs, outputs, costs);
+			lock.lock();
+
+			for (int i = 0; i < batch.size(); i++) {
+				if (batch[i]->cancels != cancels[i]) {
+					continue;
+				}
+
+				batch[i]->back.swap(batch[i]->front);
+				batch[i]->frontTag = tags[i];
+				batch[i]->frontCost = costs[i];
+				batch[i]->fresh = true;
+			}
+		}
+	}
+
+	// true if any slot has a queued frame, the mutex must be held
+	bool hasJob() const {
+		for (int i = 0; i < frameSlots.size(); i++) {
+			if (frameSlots[i]->job) {
+				return true;
+			}
+		}
+
+		return false;
+	}
+};
+
+#endif
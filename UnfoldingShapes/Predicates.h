@@ -0,0 +1,221 @@
+#ifndef PREDICATES_H
+#define PREDICATES_H
+
+#include <glm/glm.hpp>
+
+#include <cmath>
+
+// Exact geometric sign tests for float coordinates.
+// The product of two floats always fits in a double, so every determinant can be written as a sum of exact double products
+// (a product of three floats is split into two doubles that add up to it exactly).
+// The sum is first taken in plain double and only when it is too close to zero to trust is it summed again without rounding.
+static class Predicates {
+public:
+	// 1 if c is to the left of the line from a to b (counter clockwise), -1 if it is to the right and 0 if the three points are collinear
+	static int orient2d(glm::vec2 a, glm::vec2 b, glm::vec2 c) {
+		return orient2d(a, b, c, 0.0);
+	}
+
+	// same as above, but points whose orientation (twice the signed area) is within the tolerance count as collinear
+	static int orient2d(glm::vec2 a, glm::vec2 b, glm::vec2 c, double tolerance) {
+		double left = ((double)a.x - c.x) * ((double)b.y - c.y);
+		double right = ((double)a.y - c.y) * ((double)b.x - c.x);
+		double determinant = left - right;
+
+		if (tolerance > 0 && std::abs(determinant) <= tolerance) {
+			return 0;
+		}
+
+		// the rounded determinant is only trusted when it is further from zero than its worst case error
+		double errorBound = orient2dErrorBound * (std::abs(left) + std::abs(right));
+		if (determinant > errorBound) {
+			return 1;
+		}
+		if (determinant < -errorBound) {
+			return -1;
+		}
+
+		return orient2dExact(a, b, c);
+	}
+
+	// 1 if d is below the plane through a, b and c, -1 if it is above it and 0 if the four points are coplanar
+	// (below is the side from which a, b and c appear clockwise)
+	static int orient3d(glm::vec3 a, glm::vec3 b, glm::vec3 c, glm::vec3 d) {
+		return orient3d(a, b, c, d, 0.0);
+	}
+
+	// same as above, but points whose orientation (six times the signed volume) is within the tolerance count as coplanar
+	static int orient3d(glm::vec3 a, glm::vec3 b, glm::vec3 c, glm::vec3 d, double tolerance) {
+		double adx = (double)a.x - d.x, ady = (double)a.y - d.y, adz = (double)a.z - d.z;
+		double bdx = (double)b.x - d.x, bdy = (double)b.y - d.y, bdz = (double)b.z - d.z;
+		double cdx = (double)c.x - d.x, cdy = (double)c.y - d.y, cdz = (double)c.z - d.z;
+
+		double bdxcdy = bdx * cdy, cdxbdy = cdx * bdy;
+		double cdxady = cdx * ady, adxcdy = adx * cdy;
+		double adxbdy = adx * bdy, bdxady = bdx * ady;
+
+		double determinant = adz * (bdxcdy - cdxbdy) + bdz * (cdxady - adxcdy) + cdz * (adxbdy - bdxady);
+
+		if (tolerance > 0 && std::abs(determinant) <= tolerance) {
+			return 0;
+		}
+
+		double permanent = (std::abs(bdxcdy) + std::abs(cdxbdy)) * std::abs(adz) +
+			(std::abs(cdxady) + std::abs(adxcdy)) * std::abs(bdz) +
+			(std::abs(adxbdy) + std::abs(bdxady)) * std::abs(cdz);
+
+		double errorBound = orient3dErrorBound * permanent;
+		if (determinant > errorBound) {
+			return 1;
+		}
+		if (determinant < -errorBound) {
+			return -1;
+		}
+
+		return orient3dExact(a, b, c, d);
+	}
+
+	// true if c lies within the distance of the line through a and b (exactly on it for a distance of 0)
+	static bool collinear(glm::vec3 a, glm::vec3 b, glm::vec3 c, double distance = 0.0) {
+		// twice the area of the triangle in each coordinate plane, the area is the distance times the length of a to b
+		double tolerance = distance * glm::length(glm::dvec3(b) - glm::dvec3(a));
+
+		return orient2d(glm::vec2(a.x, a.y), glm::vec2(b.x, b.y), glm::vec2(c.x, c.y), tolerance) == 0 &&
+			orient2d(glm::vec2(a.y, a.z), glm::vec2(b.y, b.z), glm::vec2(c.y, c.z), tolerance) == 0 &&
+			orient2d(glm::vec2(a.z, a.x), glm::vec2(b.z, b.x), glm::vec2(c.z, c.x), tolerance) == 0;
+	}
+
+	// true if d lies within the distance of the plane through a, b and c (exactly in it for a distance of 0)
+	static bool coplanar(glm::vec3 a, glm::vec3 b, glm::vec3 c, glm::vec3 d, double distance = 0.0) {
+		// the volume is the distance times twice the area of a, b, c
+		double tolerance = distance * glm::length(glm::cross(glm::dvec3(b) - glm::dvec3(a), glm::dvec3(c) - glm::dvec3(a)));
+
+		return orient3d(a, b, c, d, tolerance) == 0;
+	}
+
+private:
+	// relative rounding error of one double operation
+	static constexpr double epsilon = 1.1102230246251565e-16;
+
+	// error bound of the rounded 2D determinant relative to the magnitude of its two products
+	static constexpr double orient2dErrorBound = (3.0 + 16.0 * epsilon) * epsilon;
+
+	// error bound of the rounded 3D determinant relative to its permanent
+	static constexpr double orient3dErrorBound = (7.0 + 56.0 * epsilon) * epsilon;
+
+	// most terms passed to sign (orient3dExact)
+	static const int maxTerms = 48;
+
+	static int orient2dExact(glm::vec2 a, glm::vec2 b, glm::vec2 c) {
+		// (a - c) x (b - c) expanded so that every term is a product of two inputs (the c.x * c.y terms cancel)
+		double terms[6] = {
+			(double)a.x * b.y,
+			-(double)a.x * c.y,
+			-(double)c.x * b.y,
+			-(double)a.y * b.x,
+			(double)a.y * c.x,
+			(double)c.y * b.x
+		};
+
+		return sign(terms, 6);
+	}
+
+	static int orient3dExact(glm::vec3 a, glm::vec3 b, glm::vec3 c, glm::vec3 d) {
+		// (a - d) . ((b - d) x (c - d)) = |a b c| - |d b c| - |a d c| - |a b d|, each 3x3 determinant has 6 products of three inputs
+		double terms[maxTerms];
+		int count = 0;
+
+		addDeterminant(a, b, c, 1.0, terms, count);
+		addDeterminant(d, b, c, -1.0, terms, count);
+		addDeterminant(a, d, c, -1.0, terms, count);
+		addDeterminant(a, b, d, -1.0, terms, count);
+
+		return sign(terms, count);
+	}
+
+	// the 6 products of p . (q x r), each as two doubles
+	static void addDeterminant(glm::vec3 p, glm::vec3 q, glm::vec3 r, double s, double* terms, int &count) {
+		addProduct(p.x, q.y, r.z, s, terms, count);
+		addProduct(p.x, q.z, r.y, -s, terms, count);
+		addProduct(p.y, q.z, r.x, s, terms, count);
+		addProduct(p.y, q.x, r.z, -s, terms, count);
+		addProduct(p.z, q.x, r.y, s, terms, count);
+		addProduct(p.z, q.y, r.x, -s, terms, count);
+	}
+
+	static void addProduct(float x, float y, float z, double s, double* terms, int &count) {
+		// x * y is exact in double, the product with z is rounded and fma gives back exactly what was lost
+		double xy = s * x * y;
+		double product = xy * z;
+
+		terms[count++] = product;
+		terms[count++] = std::fma(xy, (double)z, -product);
+	}
+
+	// sign of the exact sum of up to maxTerms doubles
+	static int sign(const double* terms, int count) {
+		double sum = 0;
+		double magnitude = 0;
+		for (int i = 0; i < count; i++) {
+			sum += terms[i];
+			magnitude += std::abs(terms[i]);
+		}
+
+		// each addition is off by at most epsilon times the running magnitude
+		double errorBound = (2 * count) * epsilon * magnitude;
+		if (sum > errorBound) {
+			return 1;
+		}
+		if (sum < -errorBound) {
+			return -1;
+		}
+
+		// exact sum as a list of non overlapping doubles from the smallest to the largest
+		// the sign of the largest part is the sign of the whole sum
+		double expansion[maxTerms];
+		int length = 0;
+		for (int i = 0; i < count; i++) {
+			growExpansion(expansion, length, terms[i]);
+		}
+
+		if (length == 0) {
+			return 0;
+		}
+
+		return expansion[length - 1] > 0 ? 1 : -1;
+	}
+
+	// a + b = sum + error exactly
+	static double twoSum(double a, double b, double &error) {
+		double sum = a + b;
+		double bVirtual = sum - a;
+		double aVirtual = sum - bVirtual;
+
+		error = (a - aVirtual) + (b - bVirtual);
+
+		return sum;
+	}
+
+	// add a double to an expansion and drop the parts that became zero
+	static void growExpansion(double* expansion, int &length, double value) {
+		double carry = value;
+		int newLength = 0;
+
+		for (int i = 0; i < length; i++) {
+			double error;
+			carry = twoSum(carry, expansion[i], error);
+
+			if (error != 0) {
+				expansion[newLength++] = error;
+			}
+		}
+
+		if (carry != 0) {
+			expansion[newLength++] = carry;
+		}
+
+		length = newLength;
+	}
+};
+
+#endif
@@ -0,0 +1,117 @@
+#ifndef ROOTSELECTION_H
+#define ROOTSELECTION_H
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtx/string_cast.hpp>
+
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <cfloat>
+
+#include "Face.h"
+#include "FaceAdjacency.h"
+#include "NetValidation.h"
+#include "Unfold.h"
+#include "WorkerPool.h"
+
+// Picks the base face of a shape by unfolding from every candidate root at once and scoring the flat nets.
+// The roots are spread over the shared WorkerPool, every task reads the same FaceAdjacency and only the trees and scores are per task.
+static class RootSelection {
+public:
+	struct Score {
+		// number of face pairs that overlap once flattened
+		int overlaps;
+
+		// area of the bounding box of the net on the root plane
+		float footprint;
+
+		Score() {
+			overlaps = 0;
+			footprint = 0.0f;
+		}
+
+		// less overlap is always better, the footprint breaks ties
+		bool operator<(const Score &s) const {
+			if (overlaps != s.overlaps) {
+				return overlaps < s.overlaps;
+			}
+
+			return footprint < s.footprint;
+		}
+	};
+
+	// index based patterns that can be scored from any root
+	enum Pattern {
+		DEPTH_FIRST,
+		BREADTH_FIRST,
+		SOURCE
+	};
+
+	struct Result {
+		int root;
+		UnfoldTree tree;
+		Score score;
+
+		Result() {
+			root = -1;
+		}
+	};
+
+	// evaluate the pattern from every face and return the best one
+	static Result findBestRoot(const FaceAdjacency &adjacency, Pattern pattern) {
+		Result best;
+
+		if (adjacency.size() == 0) {
+			return best;
+		}
+
+		// each candidate root writes to its own slot so the tasks never share mutable data
+		vector<Score> scores(adjacency.size());
+
+		WorkerPool::shared().run(adjacency.size(), [&](int root) {
+			UnfoldTree tree = buildTree(adjacency, root, pattern);
+			scores[root] = scoreTree(adjacency, tree);
+		});
+
+		// pick the lowest score (the lowest index wins ties so the result is stable)
+		best.root = 0;
+		for (int i = 1; i < scores.size(); i++) {
+			if (scores[i] < scores[best.root]) {
+				best.root = i;
+			}
+		}
+
+		best.tree = buildTree(adjacency, best.root, pattern);
+		best.score = scores[best.root];
+
+		return best;
+	}
+
+	static UnfoldTree buildTree(const FaceAdjacency &adjacency, int root, Pattern pattern) {
+		switch (pattern) {
+		case BREADTH_FIRST:
+			return Unfold::breadthFirstTree(adjacency, root);
+		case SOURCE:
+			return Unfold::sourceTree(adjacency, root);
+		default:
+			return Unfold::depthFirstTree(adjacency, root);
+		}
+	}
+
+	// flatten the tree onto the plane of its root and measure it
+	static Score scoreTree(const FaceAdjacency &adjacency, const UnfoldTree &tree) {
+		Score score;
+
+		NetValidation::Result result = NetValidation::validate(adjacency, tree);
+
+		glm::vec2 bounds = result.max - result.min;
+		score.footprint = bounds.x * bounds.y;
+		score.overlaps = result.overlaps.size();
+
+		return score;
+	}
+};
+
+#endif
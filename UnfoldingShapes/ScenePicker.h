@@ -0,0 +1,186 @@
+#ifndef SCENEPICKER_H
+#define SCENEPICKER_H
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <vector>
+#include <cfloat>
+#include <cmath>
+
+#include "Asset.h"
+#include "Model.h"
+#include "Mesh.h"
+#include "TriangleBVH.h"
+
+using namespace std;
+
+// Finds the mesh under the mouse by casting a ray through a triangle BVH over every visible asset.
+// The hierarchy is only rebuilt when the set of visible assets (or their meshes) changes,
+// every other update refits it to the current (animated) world positions, so update right before picking rather than every frame.
+class ScenePicker {
+public:
+	struct Hit {
+		Asset* asset;
+
+		// index into asset->model->meshes (one mesh per face for shapes)
+		int mesh;
+
+		// world position of the hit and its distance along the ray
+		glm::vec3 point;
+		float distance;
+
+		Hit() {
+			asset = nullptr;
+			mesh = -1;
+			point = glm::vec3(0);
+			distance = FLT_MAX;
+		}
+	};
+
+	ScenePicker() {
+
+	}
+
+	// bring the hierarchy up to date with the scene (call before picking so it follows the animation)
+	void update(const vector<Asset*> &scene) {
+		vector<Asset*> visible;
+		for (int i = 0; i < scene.size(); i++) {
+			if (scene[i]->visible && scene[i]->model != nullptr) {
+				visible.push_back(scene[i]);
+			}
+		}
+
+		bool changed = visible != assets;
+		for (int i = 0; i < visible.size() && !changed; i++) {
+			changed = visible[i]->model->meshes.size() != meshCounts[i];
+		}
+
+		if (changed) {
+			assets = visible;
+			meshCounts.clear();
+			for (int i = 0; i < assets.size(); i++) {
+				meshCounts.push_back(assets[i]->model->meshes.size());
+			}
+		}
+
+		collectTriangles();
+
+		if (changed) {
+			hierarchy = TriangleBVH(triangles);
+		}
+		else {
+			hierarchy.refit(triangles);
+		}
+	}
+
+	// closest mesh hit by the ray (the direction does not have to be normalized, the distance is then measured in its length)
+	bool pick(glm::vec3 origin, glm::vec3 direction, Hit &hit) const {
+		float distance = FLT_MAX;
+
+		int item = hierarchy.raycast(origin, direction, distance, [&](int item, float &t) {
+			const glm::vec3* corners = &triangles[hierarchy.getFace(item)][hierarchy.getOffset(item)];
+			return rayTriangle(origin, direction, corners[0], corners[1], corners[2], t);
+		});
+
+		if (item == -1) {
+			return false;
+		}
+
+		hit.asset = assets[faceAsset[hierarchy.getFace(item)]];
+		hit.mesh = faceMesh[hierarchy.getFace(item)];
+		hit.point = origin + direction * distance;
+		hit.distance = distance;
+
+		return true;
+	}
+
+	// ray from the camera through a point on the screen (in pixels from the top left corner)
+	static void screenRay(const Camera &camera, glm::vec2 screenPos, glm::vec2 screenSize, glm::vec3 &origin, glm::vec3 &direction) {
+		glm::vec2 device = glm::vec2(2.0f * screenPos.x / screenSize.x - 1.0f, 1.0f - 2.0f * screenPos.y / screenSize.y);
+		glm::mat4 inverse = glm::inverse(camera.projection * camera.view);
+
+		glm::vec4 nearPoint = inverse * glm::vec4(device, -1.0f, 1.0f);
+		glm::vec4 farPoint = inverse * glm::vec4(device, 1.0f, 1.0f);
+
+		origin = glm::vec3(nearPoint) / nearPoint.w;
+		direction = glm::vec3(farPoint) / farPoint.w - origin;
+	}
+
+	// Moller-Trumbore ray triangle intersection (both sides of the triangle count)
+	static bool rayTriangle(glm::vec3 origin, glm::vec3 direction, glm::vec3 a, glm::vec3 b, glm::vec3 c, float &t) {
+		glm::vec3 edge1 = b - a;
+		glm::vec3 edge2 = c - a;
+
+		glm::vec3 p = glm::cross(direction, edge2);
+		float determinant = glm::dot(edge1, p);
+
+		if (std::abs(determinant) < 1e-12f) {
+			return false;
+		}
+
+		float inverse = 1.0f / determinant;
+
+		glm::vec3 toOrigin = origin - a;
+		float u = glm::dot(toOrigin, p) * inverse;
+		if (u < 0.0f || u > 1.0f) {
+			return false;
+		}
+
+		glm::vec3 q = glm::cross(toOrigin, edge1);
+		float v = glm::dot(direction, q) * inverse;
+		if (v < 0.0f || u + v > 1.0f) {
+			return false;
+		}
+
+		t = glm::dot(edge2, q) * inverse;
+
+		return t >= 0.0f;
+	}
+
+private:
+	vector<Asset*> assets;
+	vector<int> meshCounts;
+
+	// one face per mesh of every visible asset, with 3 world space corners per triangle
+	vector<vector<glm::vec3>> triangles;
+	vector<int> faceAsset;
+	vector<int> faceMesh;
+
+	TriangleBVH hierarchy;
+
+	void collectTriangles() {
+		int face = 0;
+
+		for (int i = 0; i < assets.size(); i++) {
+			glm::mat4 model = assets[i]->getModelMatrix();
+			vector<Mesh> &meshes = assets[i]->model->meshes;
+
+			for (int j = 0; j < meshes.size(); j++, face++) {
+				if (face == triangles.size()) {
+					triangles.push_back(vector<glm::vec3>());
+					faceAsset.push_back(i);
+					faceMesh.push_back(j);
+				}
+				faceAsset[face] = i;
+				faceMesh[face] = j;
+
+				vector<glm::vec3> &corners = triangles[face];
+				corners.resize(meshes[j].indices.size());
+
+				// the vertices are stored at rest, the mesh pose moves them to where they are drawn
+				glm::mat4 transform = model * meshes[j].pose;
+
+				for (int k = 0; k < meshes[j].indices.size(); k++) {
+					corners[k] = glm::vec3(transform * glm::vec4(meshes[j].vertices[meshes[j].indices[k]].Position, 1.0f));
+				}
+			}
+		}
+
+		triangles.resize(face);
+		faceAsset.resize(face);
+		faceMesh.resize(face);
+	}
+};
+
+#endif
@@ -9,6 +9,7 @@
 
 #include <iostream>
 #include <vector>
+#include <memory>
 
 // graphics tools
 #include "Camera.h"
@@ -20,6 +21,8 @@
 #include "Face.h"
 #include "Graph.h"
 #include "Axis.h"
+#include "FaceAdjacency.h"
+#include "UnfoldSchedule.h"
 
 #include "OpenGLWidget.h"
 
@@ -27,79 +30,36 @@ inline string getNameFromPath(string path);
 
 class Shape {
 public:
-	struct Transformation {
-		float deltaAngle;
-		Axis<Face> axis;
-
-		vector<Face*> appliedFaces;
-
-		Transformation(float deltaAngle, Axis<Face>* axis, Face* appliedFace) {
-			this->deltaAngle = deltaAngle;
-			this->axis = *axis;
-
-			// clear and add one
-			this->appliedFaces = vector<Face*>();
-			this->appliedFaces.push_back(appliedFace);
-		}
-
-		Transformation(float deltaAngle, Axis<Face>* axis, vector<Face*> appliedFaces = vector<Face*>()) {
-			this->deltaAngle = deltaAngle;
-			this->axis = *axis;
-			this->appliedFaces = appliedFaces;
-		}
-
-		// apply the transformation
-		void apply() {
-			//std::cout << deltaAngle << std::endl;
-			for (int i = 0; i < appliedFaces.size(); i++) {
-				// rotate vertices
-				for (int j = 0; j < appliedFaces[i]->mesh->vertices.size(); j++) {
-					appliedFaces[i]->mesh->vertices[j].Position = axis.rotateAbout(appliedFaces[i]->mesh->vertices[j].Position, deltaAngle);
-				}
-
-				// rotate axis
-				for (int j = 0; j < appliedFaces[i]->axis.size(); j++) {
-					appliedFaces[i]->axis[j]->rotateAxisAbout(&axis, deltaAngle);
-				}
-			}
-		}
-
-		// revert the transformation
-		void revert() {
-			for (int i = 0; i < appliedFaces.size(); i++) {
-				// rotate vertices
-				for (int j = 0; j < appliedFaces[i]->mesh->vertices.size(); j++) {
-					//appliedFaces[i]->mesh->vertices[j].Position = appliedFaces[i]->mesh->backupVertices[j].Position;
-
-					appliedFaces[i]->mesh->vertices[j].Position = axis.rotateAbout(appliedFaces[i]->mesh->vertices[j].Position, -deltaAngle);
-					//std::cout << glm::to_string(appliedFaces[i]->mesh->vertices[j].Position) << std::endl;
-				}
-
-				// rotate axis
-				for (int j = 0; j < appliedFaces[i]->axis.size(); j++) {
-					appliedFaces[i]->axis[j]->rotateAxisAbout(&axis, -deltaAngle);
-					appliedFaces[i]->axis[j]->revert();
-				}
-			}
-		}
-	};
-
 	Asset* asset;
 	Model* model;
 	
 	vector<Face*> faces;
 	Graph<Face> faceMap;
 
+	// read only index based copy of the faceMap (safe to share between threads)
+	FaceAdjacency adjacency;
+
 	Graph<Face>* unfold;
 
-	// stores the transformations applied to the shape so we can revert.
-	vector<Transformation> appliedTransformations;
+	// index based copy of the unfold (kept up to date by setUnfold) that the animation poses the shape from
+	UnfoldTree unfoldTree;
+
+	// breadth first order and step spans of the unfoldTree for the animations (also kept up to date by setUnfold)
+	// setUnfold makes a new one instead of changing it, so a pose evaluated on another thread can keep using the old one
+	std::shared_ptr<const UnfoldSchedule> unfoldSchedule;
+
+	// changes every time setUnfold is called, so anything cached from an unfold can tell when it is out of date
+	unsigned int unfoldRevision;
 
 	string name;
 
 	// inactive
 	Shape() {
 		asset = nullptr;
+		unfold = nullptr;
+		unfoldRevision = 0;
+		unfoldSchedule = std::make_shared<UnfoldSchedule>();
+		posed = false;
 	}
 
 	// init Shape by setting the asset and registering all of the faces.
@@ -112,31 +72,69 @@ public:
 		std::cout << "Meshes: " << this->model->meshes.size() << std::endl;
 		asset = new Asset(this->model, pos, rot, scale);
 
+		unfold = nullptr;
+		unfoldRevision = 0;
+		unfoldSchedule = std::make_shared<UnfoldSchedule>();
+		posed = false;
+
 		initFaces();
 
 		std::cout << "finished loading: " << name << std::endl;
 	}
 
+	// the shape owns its unfold, the previous one is freed
+	// (the animator, hinge editor, search and collision checks all work from the index based tree or copies of it, never from the graph)
 	void setUnfold(Graph<Face>* newSolution) {
 		revert();
 
+		if (unfold != nullptr && unfold != newSolution) {
+			unfold->deleteNodes();
+			delete unfold;
+		}
+
 		unfold = newSolution;
+		unfoldTree = newSolution != nullptr ? UnfoldTree::fromGraph(adjacency, newSolution) : UnfoldTree();
+		unfoldSchedule = std::make_shared<UnfoldSchedule>(adjacency, unfoldTree);
+		unfoldRevision++;
 	}
 
-	// add transformation to the shape
-	void transform(float deltaAngle, Axis<Face>* axis, vector<Face*> appliedFaces) {
-		appliedTransformations.push_back(Transformation(deltaAngle, axis, appliedFaces));
-		appliedTransformations[appliedTransformations.size() - 1].apply();
+	// move every face by its transform (one per face, see UnfoldTree::faceTransforms)
+	// only the transforms change, the vertices keep their rest positions and the vertex shader applies the pose
+	void setPose(const vector<glm::mat4> &transforms) {
+		for (int i = 0; i < adjacency.size(); i++) {
+			adjacency.faces[i]->mesh->pose = transforms[i];
+		}
+
+		posed = true;
 	}
 
-	// undo transformations
+	// put every face back in its rest pose
 	void revert() {
-		// revert transformations and clear list
-		for (int i = appliedTransformations.size() - 1; i >= 0; i--) {
-			appliedTransformations[i].revert();
+		if (!posed) {
+			return;
+		}
 
-			appliedTransformations.erase(appliedTransformations.begin() + i);
+		for (int i = 0; i < adjacency.size(); i++) {
+			adjacency.faces[i]->mesh->pose = glm::mat4(1.0f);
 		}
+
+		posed = false;
+	}
+
+	// make a different face the base of the shape and rotate the shape so that face rests flat on the ground
+	void setRoot(Face* face) {
+		Graph<Face>::Node* node = faceMap.findNode(faceMap.rootNode, face);
+
+		if (node == nullptr || node == faceMap.rootNode) {
+			return;
+		}
+
+		revert();
+
+		// the faceMap connections go both ways so any node can be the root
+		faceMap.rootNode = node;
+
+		levelBase();
 	}
 
 	// returns the local position of the base
@@ -149,6 +147,9 @@ public:
 	}
 
 private:
+	// true while any face is away from its rest pose
+	bool posed;
+
 	// recursivley populate the faceMap
 	void populateFaceMap(Graph<Face>::Node* node, vector<Face*> &faces) {
 		vector<Face*> tempFaces = vector<Face*>();
@@ -196,73 +197,59 @@ private:
 		}
 	}
 
-	// set the pointers of each axis for the other connected axis and the pointer to the other neighboring face
-	void initAxisInfo() {
-		// use the facemap to assign original angles to each of the faces
-		for (int i = 0; i < faces.size(); i++) {
-			Graph<Face>::Node* current = faceMap.findNode(faceMap.rootNode, faces[i]);
-
-			if (current != nullptr) {
-				// search through all of the nodes and find the angles between them and their connections.
-				for (int j = 0; j < current->connections.size(); j++) {
-					for (int h = 0; h < current->data->axis.size(); h++) {
-						// make sure the axis is valid and has a neighbor
-						if (current->data->axis[h]->sharedAxis != nullptr) {
-							// identify leftover points to compare to find the angle
-							glm::vec3 vertex1 = current->data->mesh->getAvgPos();
-							glm::vec3 vertex2 = current->data->axis[h]->neighborFace->mesh->getAvgPos();
-
-							/*
-							for (int k = 0; k < current->data->mesh->indices.size(); k++) {
-								// if point is not on axis
-								vertex1 = current->data->mesh->vertices[current->data->mesh->indices[k]].Position;
-								if (current->data->axis[h]->hasPoint(vertex1) == false) {
-									break;
-								}
-							}
-
-							for (int k = 0; k < current->data->axis[h]->neighborFace->mesh->indices.size(); k++) {
-								// if point is not on axis
-								vertex2 = current->data->axis[h]->neighborFace->mesh->vertices[current->data->axis[h]->neighborFace->mesh->indices[k]].Position;
-								if (current->data->axis[h]->sharedAxis->hasPoint(vertex2) == false) {
-									break;
-								}
-							}
-
-							*/
-
-							// set axis original angle.
-							float angle = current->data->axis[h]->orientedAngle(vertex1, vertex2);
-							current->data->axis[h]->originalAngle = angle;
-							// current->data->axis[h]-sharedAxis->originalAngle = angle;
-						}
-					}
-				}
-			}
-		}
-	}
-
 	// rotate the entire shape so that the base face is perfectly level to the ground
+	// the rotation is baked into the rest pose (vertices, backups and axis) so unfolds stay relative to the base
 	void levelBase() {
 		// find normal of base
-		glm::vec3 normal = faceMap.rootNode->data->mesh->getNormal();
-		glm::vec3 line = normal * glm::vec3(1,0,1);
-		if (line.x != 0) {
-			line.x = 1 / line.x;
+		glm::vec3 normal = glm::normalize(faceMap.rootNode->data->mesh->getNormal());
+		glm::vec3 down = glm::vec3(0, -1, 0);
+
+		glm::vec3 pos = faceMap.rootNode->data->mesh->getAvgPos();
+
+		glm::vec3 line = glm::cross(normal, down);
+		float deltaAngle = glm::orientedAngle(normal, down, glm::length(line) > 0.0001f ? glm::normalize(line) : glm::vec3(1, 0, 0));
+
+		// already level
+		if (abs(deltaAngle) < 0.0001f) {
+			return;
 		}
-		if (line.z != 0) {
-			line.z = 1 / line.z;
+
+		// facing straight up so any horizontal line works
+		if (glm::length(line) <= 0.0001f) {
+			line = glm::vec3(1, 0, 0);
+			deltaAngle = 3.1415926535f;
 		}
 
-		line = glm::vec3(1 / line.x, line.y, 1 / line.z);
+		glm::mat4 transform(1.0f);
+		transform = glm::translate(transform, pos);
+		transform = glm::rotate(transform, deltaAngle, glm::normalize(line));
+		transform = glm::translate(transform, -pos);
 
-		glm::vec3 pos = faceMap.rootNode->data->mesh->getAvgPos();
+		glm::mat3 rotation = glm::mat3(transform);
+
+		for (int i = 0; i < model->meshes.size(); i++) {
+			Mesh* mesh = &model->meshes[i];
+
+			for (int j = 0; j < mesh->vertices.size(); j++) {
+				mesh->vertices[j].Position = glm::vec3(transform * glm::vec4(mesh->vertices[j].Position, 1.0f));
+				mesh->vertices[j].Normal = rotation * mesh->vertices[j].Normal;
+				mesh->vertices[j].Tangent = rotation * mesh->vertices[j].Tangent;
+				mesh->vertices[j].Bitangent = rotation * mesh->vertices[j].Bitangent;
+			}
 
-		Axis<Face>* axis = new Axis<Face>(line * -1.0f, line * 1.0f);
+			mesh->backupVertices = mesh->vertices;
+		}
+
+		for (int i = 0; i < faces.size(); i++) {
+			for (int j = 0; j < faces[i]->axis.size(); j++) {
+				faces[i]->axis[j]->transformRest(transform);
+			}
+		}
 
-		float deltaAngle = axis->orientedAngle(pos, glm::vec3(0, -1, 0));
+		// the rest pose moved so the index based copy has to be rebuilt (the dihedral angles come out the same for a rigid rotation)
+		adjacency = FaceAdjacency(faces);
 
-		// FIND A WAY TO ROTATE EULER ANGLES BY AXIS
+		model->rebuildMeshes();
 	}
 
 	void initFaces() {
@@ -272,6 +259,12 @@ private:
 			// faces[i]->printAxis();
 		}
 
+		// faces move rigidly, so their normals are made flat once here and only ever rotated afterwards
+		for (int i = 0; i < model->meshes.size(); i++) {
+			model->meshes[i].setFlatNormals();
+		}
+		model->rebuildMeshes();
+
 		// if there are no faces the return null
 		/*
 		if (faces.size() == 0) {
@@ -304,7 +297,8 @@ private:
 		faceMap = Graph<Face>(largest);
 		populateFaceMap(faceMap.rootNode, faces);
 
-		initAxisInfo();
+		// also sets the original angle of every axis from the dihedral angle table
+		adjacency = FaceAdjacency(faces);
 	}
 };
 
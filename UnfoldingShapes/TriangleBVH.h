@@ -0,0 +1,326 @@
+#ifndef TRIANGLEBVH_H
+#define TRIANGLEBVH_H
+
+#include <glm/glm.hpp>
+
+#include <vector>
+#include <algorithm>
+#include <cfloat>
+#include <utility>
+
+using namespace std;
+
+// Bounding volume hierarchy over the 3D triangles of every face.
+// The hierarchy is built once and then refitted to new corner positions, which keeps the tree layout
+// (and stays cheap) while the faces move a little at a time like they do during an animation.
+// The triangles are passed as 3 corners per triangle for each face, the layout must stay the same for every refit.
+class TriangleBVH {
+public:
+	static const int leafSize = 4;
+
+	TriangleBVH() {
+		padding = 0;
+	}
+
+	// every box is grown by the padding so faces lying in (almost) the same plane still find each other
+	TriangleBVH(const vector<vector<glm::vec3>> &triangles, float padding = 0.0f) {
+		this->padding = padding;
+
+		for (int i = 0; i < triangles.size(); i++) {
+			for (int j = 0; j + 2 < triangles[i].size(); j += 3) {
+				itemFace.push_back(i);
+				itemOffset.push_back(j);
+			}
+		}
+
+		itemMin = vector<glm::vec3>(itemFace.size());
+		itemMax = vector<glm::vec3>(itemFace.size());
+		updateItems(triangles);
+
+		for (int i = 0; i < itemFace.size(); i++) {
+			items.push_back(i);
+		}
+
+		if (!items.empty()) {
+			nodes.reserve(2 * (items.size() / leafSize + 1));
+			build(0, items.size());
+		}
+	}
+
+	int size() const {
+		return itemFace.size();
+	}
+
+	int getFace(int item) const {
+		return itemFace[item];
+	}
+
+	// index of the first corner of the triangle in the face's corner list
+	int getOffset(int item) const {
+		return itemOffset[item];
+	}
+
+	// recompute every bound bottom up for new corner positions
+	void refit(const vector<vector<glm::vec3>> &triangles) {
+		updateItems(triangles);
+
+		// children are always stored after their parent
+		for (int i = nodes.size() - 1; i >= 0; i--) {
+			Node &node = nodes[i];
+
+			if (node.count > 0) {
+				node.min = glm::vec3(FLT_MAX);
+				node.max = glm::vec3(-FLT_MAX);
+
+				for (int j = node.start; j < node.start + node.count; j++) {
+					node.min = glm::min(node.min, itemMin[items[j]]);
+					node.max = glm::max(node.max, itemMax[items[j]]);
+				}
+			}
+			else {
+				node.min = glm::min(nodes[node.left].min, nodes[node.right].min);
+				node.max = glm::max(nodes[node.left].max, nodes[node.right].max);
+			}
+		}
+	}
+
+	// call back with every pair of triangles (as items, from different faces) whose bounds touch
+	template <class F>
+	void selfPairs(F callback) const {
+		if (nodes.empty()) {
+			return;
+		}
+
+		vector<pair<int, int>> stack;
+		stack.push_back(make_pair(0, 0));
+
+		while (!stack.empty()) {
+			int a = stack.back().first;
+			int b = stack.back().second;
+			stack.pop_back();
+
+			const Node &nodeA = nodes[a];
+			const Node &nodeB = nodes[b];
+
+			// a node against itself: both halves against themselves and against each other
+			if (a == b) {
+				if (nodeA.count > 0) {
+					for (int i = nodeA.start; i < nodeA.start + nodeA.count; i++) {
+						for (int j = i + 1; j < nodeA.start + nodeA.count; j++) {
+							testItems(items[i], items[j], callback);
+						}
+					}
+				}
+				else {
+					stack.push_back(make_pair(nodeA.left, nodeA.left));
+					stack.push_back(make_pair(nodeA.right, nodeA.right));
+					pushIfOverlapping(nodeA.left, nodeA.right, stack);
+				}
+				continue;
+			}
+
+			if (nodeA.count > 0 && nodeB.count > 0) {
+				for (int i = nodeA.start; i < nodeA.start + nodeA.count; i++) {
+					for (int j = nodeB.start; j < nodeB.start + nodeB.count; j++) {
+						testItems(items[i], items[j], callback);
+					}
+				}
+			}
+			// open the larger node (or the only inner one)
+			else if (nodeB.count > 0 || (nodeA.count == 0 && extent(nodeA) >= extent(nodeB))) {
+				pushIfOverlapping(nodeA.left, b, stack);
+				pushIfOverlapping(nodeA.right, b, stack);
+			}
+			else {
+				pushIfOverlapping(a, nodeB.left, stack);
+				pushIfOverlapping(a, nodeB.right, stack);
+			}
+		}
+	}
+
+	// closest item hit by the ray origin + direction * t with t between 0 and distance (which is lowered to the hit)
+	// intersect(item, t) tests the triangle of one item and returns true with t set if the ray hits it
+	// nodes are opened nearest first and skipped once they start further away than the closest hit so far
+	template <class F>
+	int raycast(glm::vec3 origin, glm::vec3 direction, float &distance, F intersect) const {
+		int closest = -1;
+
+		if (nodes.empty()) {
+			return closest;
+		}
+
+		glm::vec3 inverse = 1.0f / direction;
+
+		float entry;
+		if (!rayHitsBox(nodes[0], origin, inverse, distance, entry)) {
+			return closest;
+		}
+
+		vector<pair<float, int>> stack;
+		stack.push_back(make_pair(entry, 0));
+
+		while (!stack.empty()) {
+			float start = stack.back().first;
+			const Node &node = nodes[stack.back().second];
+			stack.pop_back();
+
+			if (start > distance) {
+				continue;
+			}
+
+			if (node.count > 0) {
+				for (int i = node.start; i < node.start + node.count; i++) {
+					float t;
+					if (intersect(items[i], t) && t >= 0.0f && t < distance) {
+						distance = t;
+						closest = items[i];
+					}
+				}
+				continue;
+			}
+
+			float leftEntry, rightEntry;
+			bool left = rayHitsBox(nodes[node.left], origin, inverse, distance, leftEntry);
+			bool right = rayHitsBox(nodes[node.right], origin, inverse, distance, rightEntry);
+
+			// the nearer child goes on top of the stack
+			if (left && right && leftEntry < rightEntry) {
+				stack.push_back(make_pair(rightEntry, node.right));
+				stack.push_back(make_pair(leftEntry, node.left));
+			}
+			else {
+				if (left) {
+					stack.push_back(make_pair(leftEntry, node.left));
+				}
+				if (right) {
+					stack.push_back(make_pair(rightEntry, node.right));
+				}
+			}
+		}
+
+		return closest;
+	}
+
+private:
+	struct Node {
+		glm::vec3 min;
+		glm::vec3 max;
+
+		// children for inner nodes, a range of items for leaves (count is 0 for inner nodes)
+		int left, right;
+		int start, count;
+	};
+
+	// one item per triangle
+	vector<int> itemFace;
+	vector<int> itemOffset;
+	vector<glm::vec3> itemMin;
+	vector<glm::vec3> itemMax;
+
+	float padding;
+
+	vector<int> items;
+	vector<Node> nodes;
+
+	void updateItems(const vector<vector<glm::vec3>> &triangles) {
+		for (int i = 0; i < itemFace.size(); i++) {
+			const glm::vec3* corners = &triangles[itemFace[i]][itemOffset[i]];
+
+			itemMin[i] = glm::min(corners[0], glm::min(corners[1], corners[2])) - glm::vec3(padding);
+			itemMax[i] = glm::max(corners[0], glm::max(corners[1], corners[2])) + glm::vec3(padding);
+		}
+	}
+
+	// split the items at the median of the longest side of their centers
+	int build(int start, int end) {
+		int index = nodes.size();
+		nodes.push_back(Node());
+
+		glm::vec3 min(FLT_MAX), max(-FLT_MAX);
+		glm::vec3 centerMin(FLT_MAX), centerMax(-FLT_MAX);
+		for (int i = start; i < end; i++) {
+			min = glm::min(min, itemMin[items[i]]);
+			max = glm::max(max, itemMax[items[i]]);
+
+			glm::vec3 center = (itemMin[items[i]] + itemMax[items[i]]) * 0.5f;
+			centerMin = glm::min(centerMin, center);
+			centerMax = glm::max(centerMax, center);
+		}
+		nodes[index].min = min;
+		nodes[index].max = max;
+
+		if (end - start <= leafSize) {
+			nodes[index].left = nodes[index].right = -1;
+			nodes[index].start = start;
+			nodes[index].count = end - start;
+			return index;
+		}
+
+		glm::vec3 extent = centerMax - centerMin;
+		int axis = 0;
+		if (extent.y > extent[axis]) {
+			axis = 1;
+		}
+		if (extent.z > extent[axis]) {
+			axis = 2;
+		}
+
+		int middle = (start + end) / 2;
+		std::nth_element(items.begin() + start, items.begin() + middle, items.begin() + end, [&](int a, int b) {
+			return itemMin[a][axis] + itemMax[a][axis] < itemMin[b][axis] + itemMax[b][axis];
+		});
+
+		int left = build(start, middle);
+		int right = build(middle, end);
+
+		nodes[index].left = left;
+		nodes[index].right = right;
+		nodes[index].start = start;
+		nodes[index].count = 0;
+
+		return index;
+	}
+
+	void pushIfOverlapping(int a, int b, vector<pair<int, int>> &stack) const {
+		if (boundsOverlap(nodes[a].min, nodes[a].max, nodes[b].min, nodes[b].max)) {
+			stack.push_back(make_pair(a, b));
+		}
+	}
+
+	template <class F>
+	void testItems(int a, int b, F &callback) const {
+		if (itemFace[a] == itemFace[b] || !boundsOverlap(itemMin[a], itemMax[a], itemMin[b], itemMax[b])) {
+			return;
+		}
+
+		callback(a, b);
+	}
+
+	static bool boundsOverlap(glm::vec3 minA, glm::vec3 maxA, glm::vec3 minB, glm::vec3 maxB) {
+		return minA.x <= maxB.x && minB.x <= maxA.x &&
+			minA.y <= maxB.y && minB.y <= maxA.y &&
+			minA.z <= maxB.z && minB.z <= maxA.z;
+	}
+
+	// slab test, entry is where the ray enters the box (0 if it starts inside)
+	static bool rayHitsBox(const Node &node, glm::vec3 origin, glm::vec3 inverse, float distance, float &entry) {
+		glm::vec3 toMin = (node.min - origin) * inverse;
+		glm::vec3 toMax = (node.max - origin) * inverse;
+
+		glm::vec3 low = glm::min(toMin, toMax);
+		glm::vec3 high = glm::max(toMin, toMax);
+
+		entry = std::max(std::max(low.x, low.y), std::max(low.z, 0.0f));
+		float exit = std::min(std::min(high.x, high.y), std::min(high.z, distance));
+
+		return entry <= exit;
+	}
+
+	// sum of the side lengths (flat nodes have no volume)
+	static float extent(const Node &node) {
+		glm::vec3 size = node.max - node.min;
+		return size.x + size.y + size.z;
+	}
+};
+
+#endif
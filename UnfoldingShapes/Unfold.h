@@ -8,6 +8,10 @@
 
 #include <iostream>
 #include <vector>
+#include <queue>
+#include <cfloat>
+#include <cmath>
+#include <algorithm>
 
 #include "Model.h"
 #include "Mesh.h"
@@ -16,6 +20,9 @@
 #include "Graph.h"
 #include "Shape.h"
 #include "Axis.h"
+#include "FaceAdjacency.h"
+#include "NetLayout.h"
+#include "OrientedBounds.h"
 
 //prototypes
 template<class RandomIt>
@@ -127,6 +134,72 @@ private:
 		}
 	}
 
+	// queue entry for the source unfolding (total length of the path so far, face reached, where it came from and the source image)
+	struct SourceStep {
+		float distance;
+		int face;
+		int parent;
+		int edge;
+		glm::vec3 image;
+
+		SourceStep(float distance, int face, int parent, int edge, glm::vec3 image) {
+			this->distance = distance;
+			this->face = face;
+			this->parent = parent;
+			this->edge = edge;
+			this->image = image;
+		}
+
+		bool operator>(const SourceStep &s) const {
+			return distance > s.distance;
+		}
+	};
+
+	// checks if the segment a-b passes through the edge segment p1-p2 (all points must lie on the same plane)
+	static bool segmentCrossing(glm::vec3 a, glm::vec3 b, glm::vec3 p1, glm::vec3 p2, glm::vec3 &crossing) {
+		glm::vec3 edge = p2 - p1;
+		glm::vec3 path = b - a;
+
+		// solve a + path * t = p1 + edge * s in the least squares sense
+		glm::vec3 normal = glm::cross(path, edge);
+		float denominator = glm::dot(normal, normal);
+
+		if (denominator <= 0.0f) {
+			return false;
+		}
+
+		float t = glm::dot(glm::cross(p1 - a, edge), normal) / denominator;
+		float s = glm::dot(glm::cross(p1 - a, path), normal) / denominator;
+
+		crossing = p1 + edge * s;
+
+		return t >= 0.0f && t <= 1.0f && s >= 0.0f && s <= 1.0f;
+	}
+
+	// iterative so large meshes do not run out of stack
+	static void depthFirstPopulation(const FaceAdjacency &adjacency, UnfoldTree &tree, int root) {
+		// pairs of (face, next hinge to try)
+		vector<std::pair<int, int>> stack;
+		stack.push_back(std::make_pair(root, 0));
+
+		while (!stack.empty()) {
+			int current = stack.back().first;
+			int i = stack.back().second++;
+
+			if (i >= adjacency.edges[current].size()) {
+				stack.pop_back();
+				continue;
+			}
+
+			int neighbor = adjacency.edges[current][i].neighbor;
+
+			if (!tree.contains(neighbor)) {
+				tree.attach(current, neighbor, i);
+				stack.push_back(std::make_pair(neighbor, 0));
+			}
+		}
+	}
+
 public:
 	static Graph<Face>* basic(Shape* shape) {
 		// init solution with the base 
@@ -176,207 +249,218 @@ public:
 		return solution;
 	}
 
-	// returns the minimum and maximum corners of an unfold on a flat plane (returns "0,0 0,0" if there are no vertices)
-	// Shape must have an unfold Assigned!
-	// Assumes that the shape is rotated so the root unfold node is perfectly aligned with the xz plane
-	static std::tuple<glm::vec2, glm::vec2> findUnfoldSize(Shape* shape) {
-		// find the position of each vertex in the unraveled 
-		float minx = 0;
-		float miny = 0;
-		float maxx = 0;
-		float maxy = 0;
-
-		// unwrap the shape to measure
-		if (shape->unfold == nullptr) {
-			return std::make_tuple(glm::vec2(0), glm::vec2(0));
-		}
+	// Source unfolding: every face hangs off the face it is reached through by the shortest path over the surface from the base
+	// The cuts end up along the edges where shortest paths from different directions meet (the cut locus of the source)
+	static Graph<Face>* sourceUnfold(Shape* shape) {
+		int root = shape->adjacency.indexOf(shape->faceMap.rootNode->data);
 
-		// must ensure that the shape is normalized before calculations (reverted-see shape transformation struct)
-		shape->revert();
-		breadthFirstUpdate(shape, shape->unfold, 1.0);
+		return sourceTree(shape->adjacency, root).toGraph(shape->adjacency);
+	}
 
-		for (int i = 0; i < shape->faces.size(); i++) {
-			vector<Vertex>* vertices = &(shape->faces[i]->mesh->vertices);
-			
-			for (int j = 0; j < vertices->size(); j++) {
-				glm::vec3 pos = (*vertices)[j].Position;
+	// Index based patterns
+	// These only read the adjacency so they can run on several threads at once and start from any root face
 
-				if (pos.x < minx) {
-					minx = pos.x;
-				}
-				if (pos.x > maxx) {
-					maxx = pos.x;
-				}
-				if (pos.z < miny) {
-					miny = pos.z;
-				}
-				if (pos.z > maxy) {
-					maxy = pos.z;
-				}
-			}
-		}
+	// depth first pattern over the adjacency starting at the root face
+	static UnfoldTree depthFirstTree(const FaceAdjacency &adjacency, int root) {
+		UnfoldTree tree(adjacency.size(), root);
 
-		// reset shape to defualt shape and return
-		shape->revert();
+		depthFirstPopulation(adjacency, tree, root);
 
-		// output the bounds
-		//std::cout << "Calculated Bounds -- Minimum (-1, -1) Point: " + glm::to_string(glm::vec2(minx, miny)) + ", Maximum (1, 1) Point: " + glm::to_string(glm::vec2(maxx, maxy)) << std::endl;
-		return std::make_tuple(glm::vec2(minx,miny), glm::vec2(maxx,maxy));
+		return tree;
 	}
 
-	// Functions to apply the unfold
+	// breadth first pattern over the adjacency starting at the root face
+	static UnfoldTree breadthFirstTree(const FaceAdjacency &adjacency, int root) {
+		UnfoldTree tree(adjacency.size(), root);
 
-	// Enter a pointer to the list of faces you want to generate and the current root node 
-	// The function will add all of the children of the entered node to the list
-	static void recursiveChildCompilation(vector<Face*>* list, Graph<Face>::Node* root) {
-		// add face of node
-		list->push_back(root->data);
+		vector<int> queue;
+		queue.push_back(root);
 
-		// process children of node
-		for (int i = 0; i < root->connections.size(); i++) {
-			recursiveChildCompilation(list, root->connections[i]);
+		for (int i = 0; i < queue.size(); i++) {
+			int current = queue[i];
+
+			for (int j = 0; j < adjacency.edges[current].size(); j++) {
+				int neighbor = adjacency.edges[current][j].neighbor;
+
+				if (!tree.contains(neighbor)) {
+					tree.attach(current, neighbor, j);
+					queue.push_back(neighbor);
+				}
+			}
 		}
+
+		return tree;
 	}
 
-	// Enter the shape to manipulate and the root node of the generated unfold graph followed by the progress of the unfold (0.0-1.0)
-	// Automatically reverts the shape at the beginning of method
-	static void stepBasedUpdate(Shape* shape, Graph<Face>* graph, float progress) {
-		// set shape to default orientation before manipulation
-		shape->revert();
+	// shortest path tree from the center of the root face using Dijkstra over the faces (O(n log n))
+	// the source is carried along each path as an image unfolded into the plane of the current face,
+	// so the distance to a face is the straight line length of the path once it is laid flat.
+	// If that line misses the shared edge the path bends around the nearest corner of the edge instead.
+	static UnfoldTree sourceTree(const FaceAdjacency &adjacency, int root) {
+		UnfoldTree tree(adjacency.size(), root);
 
-		// begin manipulation
-		// the progress required for each level of faces to unfold
-		float miniProgress = 1.0f / graph->size;
+		vector<float> distance(adjacency.size(), FLT_MAX);
+		vector<bool> settled(adjacency.size(), false);
 
-		vector<Graph<Face>::Node*> queue;
+		// position of the source unfolded into the plane of each face
+		vector<glm::vec3> image(adjacency.size());
 
-		queue.push_back(graph->rootNode);
+		priority_queue<SourceStep, vector<SourceStep>, greater<SourceStep>> queue;
 
-		Graph<Face>::Node* current;
+		distance[root] = 0;
+		image[root] = adjacency.centroids[root];
+		queue.push(SourceStep(0, root, -1, -1, image[root]));
 
-		int index = 0;
+		while (!queue.empty()) {
+			SourceStep step = queue.top();
+			queue.pop();
 
-		while (queue.size() <= floor(progress / miniProgress)) {
-			current = queue[index];
+			if (settled[step.face]) {
+				continue;
+			}
 
-			//std::cout << "New Animation Frame:" << std::endl;
+			settled[step.face] = true;
+			image[step.face] = step.image;
 
-			for (int i = 0; i < current->connections.size(); i++) {
-				queue.push_back(current->connections[i]);
+			if (step.parent != -1) {
+				tree.attach(step.parent, step.face, step.edge);
 			}
 
-			index += 1;
-		}
+			for (int i = 0; i < adjacency.edges[step.face].size(); i++) {
+				const FaceAdjacency::Edge &edge = adjacency.edges[step.face][i];
 
-		// catchup all the queue indicies less than current
-		for (int z = 0; z < queue.size() && z != floor(progress / miniProgress); z++) {
-			current = queue[z];
+				if (settled[edge.neighbor]) {
+					continue;
+				}
 
-			// find axis
-			Axis<Face>* axis = nullptr;
+				// the edge angle folds the neighbor into this plane so the opposite rotation takes the source into the neighbor's plane
+				glm::mat4 unfold(1.0f);
+				unfold = glm::translate(unfold, edge.point);
+				unfold = glm::rotate(unfold, -edge.angle, edge.line);
+				unfold = glm::translate(unfold, -edge.point);
 
-			for (int i = 0; i < current->connections.size(); i++) {
-				for (int x = 0; x < current->data->axis.size(); x++) {
-					if (current->data->axis[x]->neighborFace == current->connections[i]->data) {
-						axis = current->data->axis[x];
+				glm::vec3 sourceImage = glm::vec3(unfold * glm::vec4(image[step.face], 1.0f));
+				glm::vec3 target = adjacency.centroids[edge.neighbor];
 
-						//axis->print();
+				float length;
+				glm::vec3 crossing;
 
-						break;
-					}
+				if (segmentCrossing(sourceImage, target, edge.p1, edge.p2, crossing)) {
+					length = glm::distance(sourceImage, target);
 				}
+				else {
+					// bend around the closest corner and move the image onto the line through that corner so later faces keep the same distance
+					glm::vec3 corner = (glm::distance(sourceImage, edge.p1) + glm::distance(edge.p1, target) < glm::distance(sourceImage, edge.p2) + glm::distance(edge.p2, target)) ? edge.p1 : edge.p2;
+					float toCorner = glm::distance(sourceImage, corner);
 
-				// apply to children
-				if (axis != nullptr) {
-					// use the method to add all child faces attatched to the current face for the transformation of the shape.
-					vector<Face*> appliedFaces = vector<Face*>();
-					recursiveChildCompilation(&appliedFaces, current->connections[i]);
+					length = toCorner + glm::distance(corner, target);
 
-					shape->transform(1 * (axis->originalAngle), axis, appliedFaces);
+					glm::vec3 direction = target - corner;
+					if (glm::length(direction) > 0.0f) {
+						sourceImage = corner - glm::normalize(direction) * toCorner;
+					}
+				}
+
+				if (length < distance[edge.neighbor]) {
+					distance[edge.neighbor] = length;
+					queue.push(SourceStep(length, edge.neighbor, step.face, i, sourceImage));
 				}
 			}
 		}
 
-		// handle latest update
-		current = queue[floor(progress / miniProgress)];
+		return tree;
+	}
 
-		// find axis
-		Axis<Face>* axis = nullptr;
+	// returns the minimum and maximum corners of an unfold on a flat plane (returns "0,0 0,0" if there are no vertices)
+	// Shape must have an unfold Assigned!
+	// Assumes that the shape is rotated so the root unfold node is perfectly aligned with the xz plane
+	// the net is laid out from the rest pose (see NetLayout) so the shape's meshes are not changed
+	static std::tuple<glm::vec2, glm::vec2> findUnfoldSize(Shape* shape) {
+		if (shape->unfold == nullptr) {
+			return std::make_tuple(glm::vec2(0), glm::vec2(0));
+		}
 
-		for (int i = 0; i < current->connections.size(); i++) {
-			for (int x = 0; x < current->data->axis.size(); x++) {
-				if (current->data->axis[x]->neighborFace == current->connections[i]->data) {
-					axis = current->data->axis[x];
+		NetLayout layout(shape->adjacency, UnfoldTree::fromGraph(shape->adjacency, shape->unfold));
 
-					//axis->print();
+		// the bounds of the flat net
+		return std::make_tuple(layout.min, layout.max);
+	}
 
-					break;
-				}
-			}
+	// returns the rectangle around the flat unfold (on the same plane as findUnfoldSize) that fits the largest into a box of the given size
+	// the rectangle may be turned, its angle is how far the net has to be rotated about the y axis to line it up with the box
+	static OrientedBounds::Rectangle findUnfoldRectangle(Shape* shape, glm::vec2 bounds) {
+		if (shape->unfold == nullptr) {
+			return OrientedBounds::Rectangle();
+		}
 
-			// apply to children
-			if (axis != nullptr) {
-				// use the method to add all child faces attatched to the current face for the transformation of the shape.
-				vector<Face*> appliedFaces = vector<Face*>();
-				recursiveChildCompilation(&appliedFaces, current->connections[i]);
+		NetLayout layout(shape->adjacency, UnfoldTree::fromGraph(shape->adjacency, shape->unfold));
 
-				shape->transform(1 * (axis->originalAngle) * (fmod(progress, miniProgress) / miniProgress), axis, appliedFaces);
-			}
+		vector<glm::vec2> points;
+		for (int i = 0; i < layout.positions.size(); i++) {
+			points.insert(points.end(), layout.positions[i].begin(), layout.positions[i].end());
 		}
+
+		return OrientedBounds::bestFit(OrientedBounds::convexHull(points), bounds);
+	}
+
+	// Functions to apply the unfold
+	// both only compute one transform per face down the tree and write the vertices from the rest pose, so a frame costs O(F) transforms and O(V) vertices
+
+	// Enter the shape to manipulate and the root node of the generated unfold graph followed by the progress of the unfold (0.0-1.0)
+	// the faces of the tree unfold their children one at a time in breadth first order
+	static void stepBasedUpdate(Shape* shape, Graph<Face>* graph, float progress) {
+		shape->setPose(stepBasedTransforms(shape, graph, progress));
 	}
 
 	// Current working solution
 	// Enter the shape to manipulate and the root node of the generated unfold graph followed by the progress of the unfold (0.0-1.0)
-	// Automatically reverts the shape at the beginning of method
+	// every hinge is rotated by the same share of its angle
 	static void breadthFirstUpdate(Shape* shape, Graph<Face>* graph, float progress) {
-		// set shape to default orientation before manipulation
-		shape->revert();
-
-		// begin manipulation
-		vector<Graph<Face>::Node*> queue;
-
-		queue.push_back(graph->rootNode);
-
-		Graph<Face>::Node* current;
-
-		// debugging tool to identify axis
-		int facesVisited = 0;
+		shape->setPose(breadthFirstTransforms(shape, graph, progress));
+	}
 
-		while (!queue.empty()) {
-			current = queue[0];
-			queue.erase(queue.begin());
+	// the per face transforms the update functions pose the shape with (so they can be cached, see AnimationTimeline)
+	// the shape's own unfold is evaluated from the schedule made by setUnfold (in parallel for large trees), any other graph gets a schedule of its own first
+	static vector<glm::mat4> stepBasedTransforms(Shape* shape, Graph<Face>* graph, float progress) {
+		if (graph == shape->unfold) {
+			return shape->unfoldSchedule->stepTransforms(progress);
+		}
 
-			//std::cout << "New Animation Frame:" << std::endl;
+		UnfoldTree converted;
+		return UnfoldSchedule(shape->adjacency, treeOf(shape, graph, converted)).stepTransforms(progress);
+	}
 
-			for (int i = 0; i < current->connections.size(); i++) {
-				facesVisited += 1;
+	static vector<glm::mat4> breadthFirstTransforms(Shape* shape, Graph<Face>* graph, float progress) {
+		if (graph == shape->unfold) {
+			return shape->unfoldSchedule->continuousTransforms(progress);
+		}
 
-				// find axis
-				Axis<Face>* axis = nullptr;
+		UnfoldTree converted;
+		const UnfoldTree &tree = treeOf(shape, graph, converted);
 
-				for (int x = 0; x < current->data->axis.size(); x++) {
-					if (current->data->axis[x]->neighborFace == current->connections[i]->data) {
-						axis = current->data->axis[x];
+		return tree.faceTransforms(shape->adjacency, progress);
+	}
 
-						//axis->print();
+	// the transforms of one of the animation algorithms (0 is step based, 1 is breadth first like Animator::Animation::activeAlgorithm)
+	// at the end of the animation both leave every hinge fully open
+	static vector<glm::mat4> transforms(Shape* shape, Graph<Face>* graph, int algorithm, float progress) {
+		if (algorithm == 0 && progress < 1.0f) {
+			return stepBasedTransforms(shape, graph, progress);
+		}
 
-						break;
-					}
-				}
+		return breadthFirstTransforms(shape, graph, progress);
+	}
 
-				// apply to children
-				if (axis != nullptr) {
-					// use the method to add all child faces attatched to the current face for the transformation of the shape.
-					vector<Face*> appliedFaces = vector<Face*>();
-					recursiveChildCompilation(&appliedFaces, current->connections[i]);
+private:
+	// the shape keeps the tree of its own unfold, any other graph is converted into the given tree
+	static const UnfoldTree &treeOf(Shape* shape, Graph<Face>* graph, UnfoldTree &converted) {
+		if (graph == shape->unfold) {
+			return shape->unfoldTree;
+		}
 
-					// apply to the shape
-					shape->transform(1 * (axis->originalAngle) * progress, axis, appliedFaces);
+		converted = UnfoldTree::fromGraph(shape->adjacency, graph);
 
-					queue.push_back(current->connections[i]);
-				}
-			}
-		}
+		return converted;
 	}
 };
 
@@ -0,0 +1,335 @@
+#ifndef UNFOLDSCHEDULE_H
+#define UNFOLDSCHEDULE_H
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <vector>
+#include <deque>
+#include <cmath>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+
+#include "FaceAdjacency.h"
+#include "WorkerPool.h"
+
+using namespace std;
+
+// Everything the animations need from an unfold tree, worked out once when the unfold is set.
+// Step i of the step based animation opens the hinges of the children of the i-th face in breadth first order,
+// and since those children sit next to each other in the same order every step is one span of it.
+// At any progress the faces before the current span are fully open, the span is opening and the rest are still closed,
+// so a frame is one pass down the order without rebuilding the queue or any per hinge progress.
+// Large trees are posed by the threads of the shared WorkerPool that each take a subtree and share out the big subtrees they find below it (work stealing).
+class UnfoldSchedule {
+public:
+	// trees with fewer faces are posed on the calling thread only (as are all trees posed from inside a WorkerPool task)
+	static const int parallelFaces = 5000;
+
+	// subtrees with more faces than this are split off as their own task when posing in parallel
+	static const int taskFaces = 1024;
+
+	// breadth first order of the tree (every parent comes before its children)
+	vector<int> order;
+
+	// step i opens the faces order[stepStart[i]] to order[stepStart[i + 1] - 1] (one entry more than there are steps)
+	vector<int> stepStart;
+
+	// threadCount of 0 uses every thread of the shared WorkerPool (only for trees with at least parallelFaces faces)
+	int threadCount;
+
+	UnfoldSchedule() {
+		threadCount = 0;
+	}
+
+	UnfoldSchedule(const FaceAdjacency &adjacency, const UnfoldTree &tree) {
+		threadCount = 0;
+
+		build(adjacency, tree);
+	}
+
+	void build(const FaceAdjacency &adjacency, const UnfoldTree &tree) {
+		order = tree.order();
+
+		// an empty tree still poses every face of the shape (at rest)
+		parent = tree.size() == adjacency.size() ? tree.parent : vector<int>(adjacency.size(), -1);
+		children = tree.size() == adjacency.size() ? tree.children : vector<vector<int>>(adjacency.size());
+
+		stepStart = vector<int>(order.size() + 1, 1);
+		for (int i = 0; i < order.size(); i++) {
+			stepStart[i + 1] = stepStart[i] + children[order[i]].size();
+		}
+
+		position = vector<int>(parent.size(), -1);
+		for (int i = 0; i < order.size(); i++) {
+			position[order[i]] = i;
+		}
+
+		// children come after their parent so the sizes add up from the back of the order
+		subtreeSize = vector<int>(parent.size(), 1);
+		for (int i = order.size() - 1; i > 0; i--) {
+			subtreeSize[parent[order[i]]] += subtreeSize[order[i]];
+		}
+
+		hinges = vector<Hinge>(parent.size());
+		for (int i = 1; i < order.size(); i++) {
+			int face = order[i];
+			const FaceAdjacency::Edge &edge = adjacency.edges[parent[face]][tree.parentEdge[face]];
+
+			hinges[face].point = edge.point;
+			hinges[face].line = edge.line;
+			hinges[face].angle = edge.angle;
+			hinges[face].open = hingeTransform(hinges[face], 1.0f);
+		}
+	}
+
+	bool empty() const {
+		return order.empty();
+	}
+
+	int size() const {
+		return parent.size();
+	}
+
+	int stepCount() const {
+		return order.size();
+	}
+
+	// world transform of every face at a progress (0.0-1.0) of the step based animation
+	void stepTransforms(float progress, vector<glm::mat4> &transforms) const {
+		if (empty()) {
+			transforms.assign(size(), glm::mat4(1.0f));
+			return;
+		}
+
+		// the progress required for each face to unfold its children
+		float miniProgress = 1.0f / order.size();
+		int current = std::min((int)floor(progress / miniProgress), (int)order.size() - 1);
+		float amount = fmod(progress, miniProgress) / miniProgress;
+
+		int opening = stepStart[current];
+		int closed = stepStart[current + 1];
+
+		evaluate([&](int face, glm::mat4 &hinge) {
+			if (position[face] < opening) {
+				hinge = hinges[face].open;
+				return true;
+			}
+
+			if (position[face] < closed) {
+				hinge = hingeTransform(hinges[face], amount);
+				return true;
+			}
+
+			// a closed hinge moves the face just like its parent
+			return false;
+		}, transforms);
+	}
+
+	vector<glm::mat4> stepTransforms(float progress) const {
+		vector<glm::mat4> transforms;
+		stepTransforms(progress, transforms);
+
+		return transforms;
+	}
+
+	// world transform of every face with each hinge rotated by (angle * progress), same as UnfoldTree::faceTransforms
+	void continuousTransforms(float progress, vector<glm::mat4> &transforms) const {
+		evaluate([&](int face, glm::mat4 &hinge) {
+			hinge = hingeTransform(hinges[face], progress);
+			return true;
+		}, transforms);
+	}
+
+	vector<glm::mat4> continuousTransforms(float progress) const {
+		vector<glm::mat4> transforms;
+		continuousTransforms(progress, transforms);
+
+		return transforms;
+	}
+
+	// the transforms of one of the animation algorithms (0 is step based, 1 is continuous like Unfold::transforms)
+	void transforms(int algorithm, float progress, vector<glm::mat4> &transforms) const {
+		if (algorithm == 0 && progress < 1.0f) {
+			stepTransforms(progress, transforms);
+		}
+		else {
+			continuousTransforms(progress, transforms);
+		}
+	}
+
+private:
+	// rest state of the hinge between a face and its parent
+	struct Hinge {
+		glm::vec3 point;
+		glm::vec3 line;
+		float angle;
+
+		// the hinge fully open
+		glm::mat4 open;
+	};
+
+	// subtrees waiting to be posed by one thread (it takes from the back, the others steal from the front)
+	struct TaskQueue {
+		std::mutex mutex;
+		std::deque<int> roots;
+	};
+
+	vector<int> parent;
+	vector<vector<int>> children;
+
+	// index of every face in the order (-1 if it is not in the tree)
+	vector<int> position;
+
+	// faces in the subtree below (and including) every face
+	vector<int> subtreeSize;
+
+	// indexed by the child face of the hinge
+	vector<Hinge> hinges;
+
+	// same rotation as UnfoldTree::hingeTransform
+	static glm::mat4 hingeTransform(const Hinge &hinge, float progress) {
+		glm::mat4 transform(1.0f);
+		transform = glm::translate(transform, hinge.point);
+		transform = glm::rotate(transform, hinge.angle * progress, hinge.line);
+		transform = glm::translate(transform, -hinge.point);
+
+		return transform;
+	}
+
+	// chain every transform down the tree, hinge(face, matrix) sets the rotation between a face and its parent
+	// and returns false if the face does not move relative to its parent
+	template<typename HingeFunction>
+	void evaluate(const HingeFunction &hinge, vector<glm::mat4> &transforms) const {
+		transforms.assign(size(), glm::mat4(1.0f));
+
+		if (empty()) {
+			return;
+		}
+
+		WorkerPool &pool = WorkerPool::shared();
+		int threads = threadCount > 0 ? threadCount : pool.size();
+
+		// a pose evaluated inside a task (like a batch of animations) already has the other threads busy
+		if (order.size() < parallelFaces || threads == 1 || WorkerPool::insideTask()) {
+			glm::mat4 local;
+
+			for (int i = 1; i < order.size(); i++) {
+				int face = order[i];
+				transforms[face] = hinge(face, local) ? transforms[parent[face]] * local : transforms[parent[face]];
+			}
+
+			return;
+		}
+
+		vector<TaskQueue> queues(threads);
+		queues[0].roots.push_back(order[0]);
+
+		// subtrees that are queued or being posed, the workers stop once it reaches 0
+		std::atomic<int> pending(1);
+
+		// subtrees that are queued, idle workers sleep while it is 0
+		std::atomic<int> queued(1);
+		std::mutex idleMutex;
+		std::condition_variable idle;
+
+		auto work = [&](int self) {
+			vector<int> stack;
+			glm::mat4 local;
+
+			while (pending > 0) {
+				int root;
+				if (!takeTask(queues, self, root, queued)) {
+					std::unique_lock<std::mutex> lock(idleMutex);
+					idle.wait(lock, [&]() {
+						return pending == 0 || queued > 0;
+					});
+					continue;
+				}
+
+				// the transform of the parent was written before the subtree was queued
+				if (parent[root] != -1) {
+					transforms[root] = hinge(root, local) ? transforms[parent[root]] * local : transforms[parent[root]];
+				}
+
+				stack.assign(1, root);
+				while (!stack.empty()) {
+					int face = stack.back();
+					stack.pop_back();
+
+					// the first big subtree stays with this thread so a long chain of faces is not queued face by face
+					bool keptBig = false;
+
+					for (int i = 0; i < children[face].size(); i++) {
+						int child = children[face][i];
+
+						// other big subtrees are handed out so idle threads can steal them
+						if (subtreeSize[child] > taskFaces && keptBig) {
+							pending++;
+
+							{
+								std::lock_guard<std::mutex> lock(queues[self].mutex);
+								queues[self].roots.push_back(child);
+								queued++;
+							}
+
+							// taking the lock orders this after the check of a worker that is about to sleep
+							{
+								std::lock_guard<std::mutex> lock(idleMutex);
+							}
+							idle.notify_one();
+							continue;
+						}
+
+						keptBig = keptBig || subtreeSize[child] > taskFaces;
+
+						transforms[child] = hinge(child, local) ? transforms[face] * local : transforms[face];
+						stack.push_back(child);
+					}
+				}
+
+				if (--pending == 0) {
+					{
+						std::lock_guard<std::mutex> lock(idleMutex);
+					}
+					idle.notify_all();
+				}
+			}
+		};
+
+		// any task can drain every queue, so tasks that start late (with the pool busy elsewhere) simply find nothing left
+		pool.run(threads, work);
+	}
+
+	// newest subtree of the thread's own queue, or else the oldest one of another thread
+	static bool takeTask(vector<TaskQueue> &queues, int self, int &root, std::atomic<int> &queued) {
+		{
+			std::lock_guard<std::mutex> lock(queues[self].mutex);
+
+			if (!queues[self].roots.empty()) {
+				root = queues[self].roots.back();
+				queues[self].roots.pop_back();
+				queued--;
+				return true;
+			}
+		}
+
+		for (int i = 1; i < queues.size(); i++) {
+			TaskQueue &victim = queues[(self + i) % queues.size()];
+			std::lock_guard<std::mutex> lock(victim.mutex);
+
+			if (!victim.roots.empty()) {
+				root = victim.roots.front();
+				victim.roots.pop_front();
+				queued--;
+				return true;
+			}
+		}
+
+		return false;
+	}
+};
+
+#endif
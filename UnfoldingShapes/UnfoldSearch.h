@@ -0,0 +1,290 @@
+#ifndef UNFOLDSEARCH_H
+#define UNFOLDSEARCH_H
+
+#include <iostream>
+#include <vector>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <random>
+#include <thread>
+
+#include "FaceAdjacency.h"
+#include "RootSelection.h"
+#include "Unfold.h"
+
+// Anytime unfold search.
+// start() returns immediately and a worker thread keeps improving the net (fewer overlaps, then a smaller footprint)
+// until its time or iteration budget runs out or it is cancelled. The best net so far can be polled at any point.
+class UnfoldSearch {
+public:
+	// a value of 0 means no limit (at least one limit should be set or the search only stops when cancelled)
+	struct Budget {
+		int milliseconds;
+		int iterations;
+
+		Budget(int milliseconds = 2000, int iterations = 0) {
+			this->milliseconds = milliseconds;
+			this->iterations = iterations;
+		}
+	};
+
+	struct Snapshot {
+		UnfoldTree tree;
+		RootSelection::Score score;
+
+		// number of candidate nets scored so far
+		int iterations;
+
+		// changes every time a better net is found
+		int generation;
+
+		bool running;
+	};
+
+	UnfoldSearch() {
+		running = false;
+		cancelled = false;
+		generation = 0;
+		iterations = 0;
+	}
+
+	~UnfoldSearch() {
+		cancel();
+	}
+
+	// begin refining from an initial tree (the adjacency is copied so the shape can be used freely while searching)
+	// any search that is already running is cancelled first
+	void start(const FaceAdjacency &adjacency, const UnfoldTree &initial, Budget budget = Budget()) {
+		cancel();
+
+		this->adjacency = adjacency;
+		this->budget = budget;
+
+		best.tree = initial;
+		best.score = RootSelection::scoreTree(this->adjacency, initial);
+		best.iterations = 0;
+		best.generation = ++generation;
+		best.running = true;
+
+		iterations = 0;
+		cancelled = false;
+		running = true;
+
+		worker = std::thread(&UnfoldSearch::run, this);
+	}
+
+	// stop the search and wait for the worker to finish (the best net found is kept)
+	void cancel() {
+		cancelled = true;
+
+		if (worker.joinable()) {
+			worker.join();
+		}
+
+		running = false;
+	}
+
+	bool isRunning() {
+		return running;
+	}
+
+	// copy of the best net found so far
+	Snapshot getBest() {
+		std::lock_guard<std::mutex> lock(mutex);
+
+		Snapshot snapshot = best;
+		snapshot.iterations = iterations;
+		snapshot.running = running;
+
+		return snapshot;
+	}
+
+	// returns true and fills the snapshot if a better net was found since the generation passed in
+	bool poll(int lastGeneration, Snapshot &snapshot) {
+		std::lock_guard<std::mutex> lock(mutex);
+
+		if (best.generation == lastGeneration) {
+			return false;
+		}
+
+		snapshot = best;
+		snapshot.iterations = iterations;
+		snapshot.running = running;
+
+		return true;
+	}
+
+private:
+	FaceAdjacency adjacency;
+	Budget budget;
+
+	std::thread worker;
+	std::mutex mutex;
+
+	std::atomic<bool> running;
+	std::atomic<bool> cancelled;
+	std::atomic<int> iterations;
+
+	int generation;
+
+	// guarded by the mutex
+	Snapshot best;
+
+	// hill climbing on the spanning tree with random restarts
+	// each step moves one face (and its subtree) onto a different neighbor, which always keeps the tree spanning
+	void run() {
+		std::mt19937 random(std::random_device{}());
+		std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+		UnfoldTree current = best.tree;
+		RootSelection::Score currentScore = best.score;
+
+		int stale = 0;
+
+		while (!cancelled && !outOfBudget(startTime)) {
+			UnfoldTree candidate;
+
+			// restart from a shuffled pattern when local moves stop helping
+			if (stale > adjacency.size() * 2) {
+				candidate = randomTree(current.root, random);
+				stale = 0;
+			}
+			else {
+				candidate = current;
+				if (!reattachRandomFace(candidate, random)) {
+					candidate = randomTree(current.root, random);
+				}
+			}
+
+			RootSelection::Score score = RootSelection::scoreTree(adjacency, candidate);
+			iterations++;
+
+			if (score < currentScore || !(currentScore < score)) {
+				current = candidate;
+				currentScore = score;
+			}
+			else {
+				stale++;
+			}
+
+			if (currentScore < best.score) {
+				std::lock_guard<std::mutex> lock(mutex);
+
+				best.tree = current;
+				best.score = currentScore;
+				best.generation = ++generation;
+				stale = 0;
+			}
+		}
+
+		running = false;
+	}
+
+	bool outOfBudget(std::chrono::steady_clock::time_point startTime) {
+		if (budget.iterations > 0 && iterations >= budget.iterations) {
+			return true;
+		}
+
+		if (budget.milliseconds > 0) {
+			std::chrono::milliseconds elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime);
+
+			if (elapsed.count() >= budget.milliseconds) {
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	// breadth or depth first pattern with the neighbors visited in a random order
+	UnfoldTree randomTree(int root, std::mt19937 &random) {
+		UnfoldTree tree(adjacency.size(), root);
+		bool breadthFirst = random() % 2 == 0;
+
+		vector<int> queue;
+		queue.push_back(root);
+
+		while (!queue.empty()) {
+			int current;
+			if (breadthFirst) {
+				current = queue.front();
+				queue.erase(queue.begin());
+			}
+			else {
+				current = queue.back();
+				queue.pop_back();
+			}
+
+			vector<int> order;
+			for (int i = 0; i < adjacency.edges[current].size(); i++) {
+				order.push_back(i);
+			}
+			std::shuffle(order.begin(), order.end(), random);
+
+			for (int i = 0; i < order.size(); i++) {
+				int neighbor = adjacency.edges[current][order[i]].neighbor;
+
+				if (!tree.contains(neighbor)) {
+					tree.attach(current, neighbor, order[i]);
+					queue.push_back(neighbor);
+				}
+			}
+		}
+
+		return tree;
+	}
+
+	// move a random face onto another neighbor that is not inside its own subtree
+	bool reattachRandomFace(UnfoldTree &tree, std::mt19937 &random) {
+		if (adjacency.size() < 3) {
+			return false;
+		}
+
+		for (int attempt = 0; attempt < 8; attempt++) {
+			int face = random() % adjacency.size();
+
+			if (face == tree.root || !tree.contains(face) || adjacency.edges[face].size() < 2) {
+				continue;
+			}
+
+			// mark the subtree so it can not become its own parent
+			vector<bool> inSubtree(adjacency.size(), false);
+			vector<int> stack;
+			stack.push_back(face);
+
+			while (!stack.empty()) {
+				int current = stack.back();
+				stack.pop_back();
+
+				inSubtree[current] = true;
+				for (int i = 0; i < tree.children[current].size(); i++) {
+					stack.push_back(tree.children[current][i]);
+				}
+			}
+
+			int start = random() % adjacency.edges[face].size();
+			for (int i = 0; i < adjacency.edges[face].size(); i++) {
+				int newParent = adjacency.edges[face][(start + i) % adjacency.edges[face].size()].neighbor;
+
+				if (newParent == tree.parent[face] || inSubtree[newParent] || !tree.contains(newParent)) {
+					continue;
+				}
+
+				int edge = adjacency.findEdge(newParent, face);
+				if (edge == -1) {
+					continue;
+				}
+
+				tree.detach(face);
+				tree.attach(newParent, face, edge);
+
+				return true;
+			}
+		}
+
+		return false;
+	}
+};
+
+#endif
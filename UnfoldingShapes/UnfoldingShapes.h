@@ -2,6 +2,11 @@
 #define UNFOLDINGSHAPES_H
 
 #include <filesystem>
+#include <algorithm>
+#include <cmath>
+#include <atomic>
+#include <chrono>
+#include <future>
 
 #include <QtWidgets/QMainWindow>
 #include <QMouseEvent>
@@ -12,6 +17,13 @@
 
 #include "Shape.h"
 #include "Animator.h"
+#include "RootSelection.h"
+#include "UnfoldSearch.h"
+#include "ExactUnfold.h"
+#include "NetValidation.h"
+#include "NetMetrics.h"
+#include "ContinuousCollision.h"
+#include "HingeEditor.h"
 
 class UnfoldingShapes : public QMainWindow
 {
@@ -24,6 +36,7 @@ public:
 
 		// local init (the rest must be delayed because gl initializes after this)
 		focusedShape = nullptr;
+		galleryMode = false;
 
 		// apply button
 		connect(ui.applyProperties, &QPushButton::released, this, &UnfoldingShapes::applySettings);
@@ -39,12 +52,36 @@ public:
 
 		// render menu connections
 		connect(ui.enableTable, &QCheckBox::stateChanged, this, &UnfoldingShapes::checkTable);
+		connect(ui.galleryInput, &QCheckBox::stateChanged, this, &UnfoldingShapes::checkGallery);
 
 		// enable controls
 		ui.openGLWidget->installEventFilter(this);
 
 		// setup properties page
 		ui.propertiesTabWidget->setCurrentIndex(0);
+
+		// check the background unfold search for better nets
+		searchShape = nullptr;
+		searchGeneration = 0;
+
+		searchTimer = new QTimer(this);
+		connect(searchTimer, &QTimer::timeout, this, &UnfoldingShapes::pollSearch);
+		searchTimer->start(100);
+
+		// the same timer picks up the collision checks that finished in the background
+		connect(searchTimer, &QTimer::timeout, this, &UnfoldingShapes::pollCollisions);
+
+		hingeEditor = nullptr;
+		hingeShape = nullptr;
+	}
+
+	~UnfoldingShapes() {
+		for (int i = 0; i < collisionChecks.size(); i++) {
+			collisionChecks[i]->cancelled = true;
+			collisionChecks[i]->result.wait();
+
+			delete collisionChecks[i];
+		}
 	}
 
 	OpenGLWidget* getGraphics() {
@@ -85,6 +122,7 @@ public:
 		currentZoomStep = 7640;
 		zoom = calculateZoom(currentZoomStep);
 		currentMousePos = glm::vec2(0);
+		pressPos = glm::vec2(0);
 
 		// set camera starting pos
 		//ui.openGLWidget->camera.setPos(origin + glm::normalize(glm::vec3(0.0f, 0.5f, -1.0f)) * zoom);
@@ -122,6 +160,19 @@ public:
 			currentMousePos = currentMousePos + pos - mouse->pos;
 		}
 
+		// a click that did not drag the camera picks a face (ctrl picks the hinge closest to the click)
+		if (event->type() == QEvent::MouseButtonPress || event->type() == QEvent::MouseButtonRelease) {
+			QMouseEvent *mouseEvent = static_cast<QMouseEvent *>(event);
+			glm::vec2 pos = glm::vec2(mouseEvent->localPos().x(), mouseEvent->localPos().y());
+
+			if (event->type() == QEvent::MouseButtonPress) {
+				pressPos = pos;
+			}
+			else if (mouseEvent->button() == Qt::LeftButton && glm::length(pos - pressPos) < clickDistance) {
+				pickFace(pos, mouseEvent->modifiers() & Qt::ControlModifier);
+			}
+		}
+
 		mouse->update(event);
 
 		// apply camera rotation for the viewer and transformation
@@ -178,6 +229,16 @@ public:
 		// move the current focus back to its position
 		//backboard->applyTransform();
 
+		// the background search belongs to the old focus
+		stopSearch();
+
+		// every shape keeps animating in the gallery, the focus only picks the shape the menu and the mouse work on
+		if (galleryMode) {
+			focusedShape = shape;
+			applyUnfold(focusedShape, ui.bestRootInput->isChecked());
+			return;
+		}
+
 		// stop current animation of the focused shape
 		if (focusedShape != nullptr) {
 			animator->getAnimation(focusedShape)->stop();
@@ -195,36 +256,320 @@ public:
 
 	// runtime stuff
 	void applySettings() {
-		// retrieve info
-
+		if (galleryMode) {
+			showGallery();
+		}
 		// make sure a shape is selected in the menu
+		else if (focusedShape != nullptr) {
+			applyUnfold(focusedShape, ui.bestRootInput->isChecked());
+		}
+	}
+
+	// switch between showing only the focused shape and the gallery of every shape
+	void checkGallery(int state) {
+		galleryMode = state != 0;
+
+		if (galleryMode) {
+			showGallery();
+			return;
+		}
+
+		for (int i = 0; i < shapes->size(); i++) {
+			if ((*shapes)[i] != focusedShape) {
+				animator->getAnimation((*shapes)[i])->stop();
+				(*shapes)[i]->asset->visible = false;
+			}
+		}
+
+		// back to the whole table
 		if (focusedShape != nullptr) {
-			Shape* current = focusedShape;
+			applyUnfold(focusedShape, ui.bestRootInput->isChecked());
+		}
+	}
+
+	// unfold and animate every shape at once with the settings from the menu, the animator poses them all in one batch per frame
+	void showGallery() {
+		stopSearch();
+		clearHingeEditor();
+
+		for (int i = 0; i < shapes->size(); i++) {
+			(*shapes)[i]->asset->visible = true;
+			(*shapes)[i]->asset->setRotation(glm::vec3(0));
+
+			applyUnfold((*shapes)[i], ui.bestRootInput->isChecked());
+		}
+
+		ui.statusBar->showMessage(QString("Gallery of %1 shapes").arg(shapes->size()));
+	}
 
-			int unfoldSetting = ui.unfoldMethodInput->currentIndex();
-			int animationSetting = ui.animationMethodInput->currentIndex();
-			float speed = ui.speedInput->value();
-			float scale = ui.scaleInput->value();
+	// the cell of the table a shape is placed in while the gallery is shown (a grid that is about as wide as it is tall)
+	void galleryCell(Shape* shape, glm::vec2 &center, glm::vec2 &size) {
+		int count = shapes->size();
+		int index = std::find(shapes->begin(), shapes->end(), shape) - shapes->begin();
 
+		int columns = (int)ceil(sqrt((float)count));
+		int rows = (count + columns - 1) / columns;
+
+		glm::vec2 cell = tableBounds / glm::vec2(columns, rows);
+
+		center = glm::vec2(origin.x, origin.y) - tableBounds * 0.5f + cell * glm::vec2(index % columns + 0.5f, index / columns + 0.5f);
+
+		// leave a gap between the nets
+		size = cell * 0.9f;
+	}
+
+	// unfold, place and animate a shape with the settings from the menu
+	// findBestRoot replaces the current base with the best one for the selected pattern
+	void applyUnfold(Shape* current, bool findBestRoot) {
+		// a running search would overwrite the new settings
+		stopSearch();
+		clearHingeEditor();
+
+		// retrieve info
+		int unfoldSetting = ui.unfoldMethodInput->currentIndex();
+		int animationSetting = ui.animationMethodInput->currentIndex();
+		float duration = ui.durationInput->value();
+
+		if (findBestRoot) {
+			setBestRootUnfold(current, unfoldSetting);
+		}
+		else {
 			setUnfold(current, unfoldSetting);
+		}
 
-			// align the y position correctly
-			focusedShape->asset->position = origin - focusedShape->getBasePos();
+		placeUnfold(current);
+		checkUnfold(current, animationSetting);
 
-			// measure unfold bounds to adjust position to
-			orientUnfoldShape(current, glm::vec2(origin.x, origin.y) - (tableBounds * 0.5f), glm::vec2(origin.x, origin.y) + (tableBounds * 0.5f));
+		// startup animator
+		Animator::Animation* animation = animator->getAnimation(current);
+		animation->setAlgorithm(animationSetting);
+		animation->duration = duration;
+		animation->bakeSamples = ui.bakeInput->isChecked() ? AnimationTimeline::defaultSamples : 0;
 
-			// startup animator
-			Animator::Animation* animation = animator->getAnimation(current);
-			animation->setAlgorithm(animationSetting);
-			animation->speed = speed;
+		animation->progress = 0;
 
-			animation->progress = 0;
+		animation->play();
 
-			animation->play();
+		// show this net right away and keep improving it in the background (the search only follows one shape, so not in the gallery)
+		if (ui.refineInput->isChecked() && !galleryMode) {
+			startSearch(current, ui.refineTimeInput->value());
 		}
 	}
 
+	// position and scale the shape so its unfold fits on the table (or on its cell of the table in the gallery)
+	void placeUnfold(Shape* shape) {
+		glm::vec2 corner1, corner2;
+		placementArea(shape, corner1, corner2);
+
+		// measure unfold bounds to adjust position to
+		orientUnfoldShape(shape, corner1, corner2);
+	}
+
+	// the part of the table the shape's unfold goes on, the shape is moved to the height of the table
+	void placementArea(Shape* shape, glm::vec2 &corner1, glm::vec2 &corner2) {
+		// align the y position correctly
+		shape->asset->position = origin - shape->getBasePos();
+
+		glm::vec2 center, size;
+		placementCell(shape, center, size);
+
+		corner1 = center - (size * 0.5f);
+		corner2 = center + (size * 0.5f);
+	}
+
+	// the whole table, or the shape's cell of it in the gallery
+	void placementCell(Shape* shape, glm::vec2 &center, glm::vec2 &size) {
+		center = glm::vec2(origin.x, origin.y);
+		size = tableBounds;
+
+		if (galleryMode) {
+			galleryCell(shape, center, size);
+		}
+	}
+
+	// show the quality of the flat net, which faces of it lie on top of each other and where the continuous animation makes faces pass through each other
+	void checkUnfold(Shape* shape, int animationSetting) {
+		if (shape->unfold == nullptr) {
+			return;
+		}
+
+		UnfoldTree tree = UnfoldTree::fromGraph(shape->adjacency, shape->unfold);
+
+		// the fill is measured against the rectangle the net is placed with
+		glm::vec2 center, size;
+		placementCell(shape, center, size);
+
+		NetMetrics::Result result = NetMetrics::measure(shape->adjacency, tree, size);
+		result.print();
+
+		QString message = "Unfold has no overlapping faces";
+		if (result.overlapCount() > 0) {
+			std::cout << "Overlapping faces:";
+			for (int i = 0; i < result.overlaps.size(); i++) {
+				std::cout << " (" << result.overlaps[i].first << ", " << result.overlaps[i].second << ")";
+			}
+			std::cout << std::endl;
+
+			message = QString("Unfold has %1 overlapping face pairs").arg(result.overlaps.size());
+		}
+
+		message += QString(", cut length %1, fill %2%, depth %3").arg(result.cutLength, 0, 'f', 2).arg(result.fillRatio() * 100, 0, 'f', 1).arg(result.maxDepth);
+
+		ui.statusBar->showMessage(message);
+
+		// an older check of this shape is for a net that is no longer shown
+		for (int i = 0; i < collisionChecks.size(); i++) {
+			if (collisionChecks[i]->shape == shape) {
+				collisionChecks[i]->cancelled = true;
+			}
+		}
+
+		// only the continuous animation moves every hinge at once
+		// the check can take a while on large nets, so it runs on its own thread with copies of the adjacency and tree (see pollCollisions)
+		if (animationSetting == 1) {
+			CollisionCheck* check = new CollisionCheck();
+			check->shape = shape;
+			check->revision = shape->unfoldRevision;
+			check->message = message;
+			check->cancelled = false;
+
+			FaceAdjacency adjacency = shape->adjacency;
+			check->result = std::async(std::launch::async, [adjacency, tree, check]() {
+				return ContinuousCollision::firstCollision(adjacency, tree, 64, 4096, 8, &check->cancelled);
+			});
+
+			collisionChecks.push_back(check);
+		}
+	}
+
+	// report the collision checks that finished, a check of an unfold that has been replaced since is dropped
+	void pollCollisions() {
+		for (int i = 0; i < collisionChecks.size();) {
+			CollisionCheck* check = collisionChecks[i];
+
+			if (check->result.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+				i++;
+				continue;
+			}
+
+			ContinuousCollision::Result collision = check->result.get();
+
+			if (!check->cancelled && check->revision == check->shape->unfoldRevision) {
+				QString message = check->message;
+
+				if (collision.collides) {
+					std::cout << "Faces " << collision.faceA << " and " << collision.faceB << " collide at " << collision.progress * 100 << "% of the animation" << std::endl;
+
+					message += QString(", faces collide at %1% of the animation").arg(collision.progress * 100, 0, 'f', 1);
+				}
+				else if (!collision.bounded) {
+					std::cout << "Collision check sampled " << collision.steps << " steps, fewer than the motion of the faces needs" << std::endl;
+				}
+
+				ui.statusBar->showMessage(message);
+			}
+
+			delete check;
+			collisionChecks.erase(collisionChecks.begin() + i);
+		}
+	}
+
+	// background refinement of the current unfold
+	void startSearch(Shape* shape, float seconds) {
+		UnfoldTree initial = UnfoldTree::fromGraph(shape->adjacency, shape->unfold);
+
+		search.start(shape->adjacency, initial, UnfoldSearch::Budget(seconds * 1000));
+
+		searchShape = shape;
+		searchGeneration = search.getBest().generation;
+	}
+
+	void stopSearch() {
+		search.cancel();
+		searchShape = nullptr;
+	}
+
+	// swap in the best net found so far (the animation carries on from its current progress)
+	void pollSearch() {
+		if (searchShape == nullptr) {
+			return;
+		}
+
+		// read before polling: once the worker has stopped its last net is already published, so this poll can not miss it
+		bool running = search.isRunning();
+
+		UnfoldSearch::Snapshot snapshot;
+		if (search.poll(searchGeneration, snapshot)) {
+			searchGeneration = snapshot.generation;
+
+			if (searchShape == hingeShape) {
+				clearHingeEditor();
+			}
+
+			replaceUnfold(searchShape, snapshot.tree.toGraph(searchShape->adjacency));
+
+			ui.statusBar->showMessage(QString("Refined unfold: %1 overlaps, footprint %2 (%3 nets tried)").arg(snapshot.score.overlaps).arg(snapshot.score.footprint).arg(snapshot.iterations));
+		}
+
+		if (!running) {
+			searchShape = nullptr;
+		}
+	}
+
+	// swap in a new unfold for a shape, fit it to the table again and pose it where its animation is
+	// (setUnfold puts every face back at rest, and a finished animation is not posed by the animator any more)
+	void replaceUnfold(Shape* shape, Graph<Face>* unfold) {
+		shape->setUnfold(unfold);
+		placeUnfold(shape);
+
+		animator->getAnimation(shape)->pose();
+	}
+
+	// cut a folded hinge or fold a cut hinge of the focused shape's unfold
+	// only the part of the net that moved is laid out again, so this stays fast on large nets
+	bool toggleHinge(Face* a, Face* b) {
+		if (focusedShape == nullptr || focusedShape->unfold == nullptr) {
+			return false;
+		}
+
+		// edits would be overwritten by the next refined net
+		stopSearch();
+
+		if (hingeShape != focusedShape) {
+			clearHingeEditor();
+
+			hingeEditor = new HingeEditor(focusedShape->adjacency, UnfoldTree::fromGraph(focusedShape->adjacency, focusedShape->unfold));
+			hingeShape = focusedShape;
+		}
+
+		if (!hingeEditor->toggle(focusedShape->adjacency.indexOf(a), focusedShape->adjacency.indexOf(b))) {
+			ui.statusBar->showMessage("Hinge can not be changed (cutting it would split the net)");
+			return false;
+		}
+
+		focusedShape->setUnfold(hingeEditor->getTree().toGraph(focusedShape->adjacency));
+
+		// the net changed shape, so it is fitted (and turned) to the table again with the face corners the editor already laid out
+		glm::vec2 corner1, corner2;
+		placementArea(focusedShape, corner1, corner2);
+
+		orientUnfoldShape(focusedShape, corner1, corner2, hingeEditor->getRectangle(glm::abs(corner2 - corner1)));
+
+		// setUnfold put every face back at rest, and edits are mostly made after the animation finished (when the animator no longer poses it)
+		animator->getAnimation(focusedShape)->pose();
+
+		ui.statusBar->showMessage(QString("Hinge %1: %2 overlaps").arg(hingeEditor->isFolded(focusedShape->adjacency.indexOf(a), focusedShape->adjacency.indexOf(b)) ? "folded" : "cut").arg(hingeEditor->getOverlaps().size()));
+
+		return true;
+	}
+
+	void clearHingeEditor() {
+		delete hingeEditor;
+
+		hingeEditor = nullptr;
+		hingeShape = nullptr;
+	}
+
 	void selectFile() {
 		QString fileName = QFileDialog::getOpenFileName(this, tr("Open Shape"), "", tr("OBJ File (*.obj)"));
 
@@ -348,10 +693,21 @@ public:
 
 	// Change the position and scale of a shape so that when it is unfolded, it fits within the specified bounds
 	// specify the bounds with the rectangle formed by corner 1 and corner 2
+	// the net is turned about the y axis so its best fitting rectangle lines up with the bounds
 	void orientUnfoldShape(Shape* shape, glm::vec2 corner1, glm::vec2 corner2) {
-		glm::vec2 unfoldCorner1, unfoldCorner2;
-		std::tie(unfoldCorner1, unfoldCorner2) = Unfold::findUnfoldSize(shape);
+		orientUnfoldShape(shape, corner1, corner2, Unfold::findUnfoldRectangle(shape, glm::abs(corner2 - corner1)));
+	}
+
+	// same as above with the rectangle around the unfold already measured
+	void orientUnfoldShape(Shape* shape, glm::vec2 corner1, glm::vec2 corner2, const OrientedBounds::Rectangle &rectangle) {
+		// the model matrix rotates before it moves, so the turned rectangle bounds can be placed like axis aligned ones
+		shape->asset->setRotation(glm::vec3(shape->asset->rotation.x, glm::degrees(rectangle.angle), shape->asset->rotation.z));
 
+		orientUnfoldShape(shape, corner1, corner2, rectangle.min, rectangle.max);
+	}
+
+	// same as above with the unfold bounds already measured (in the frame of the shape's current rotation)
+	void orientUnfoldShape(Shape* shape, glm::vec2 corner1, glm::vec2 corner2, glm::vec2 unfoldCorner1, glm::vec2 unfoldCorner2) {
 		glm::vec2 bounds = glm::abs(corner2 - corner1);
 		glm::vec2 unfoldBounds = glm::abs(unfoldCorner2 - unfoldCorner1);
 
@@ -382,15 +738,17 @@ public:
 		// find offset of center and then scale it
 		glm::vec2 transformCenter = -1.0f * vec2Mult((unfoldCorner1 + unfoldBounds * 0.5f), glm::vec2(newBounds.x / unfoldBounds.x, newBounds.y / unfoldBounds.y));
 
+		// center the net on the bounds
+		glm::vec2 offset = (corner1 + corner2) * 0.5f - glm::vec2(origin.x, origin.y);
+
 		// orient the corner to corresponding position
 		//shape->asset->setPosition(glm::vec3(transformCenter.x, shape->asset->position.y, transformCenter.y) + origin - glm::vec3((bounds.x - newBounds.x) / 2.0f, 0.0f, (bounds.y - newBounds.y) / 2.0f));
-		shape->asset->setPosition(glm::vec3(transformCenter.x, shape->asset->position.y, transformCenter.y) + origin);
+		shape->asset->setPosition(glm::vec3(transformCenter.x + offset.x, shape->asset->position.y, transformCenter.y + offset.y) + origin);
 
 		// adjust y pos so it stays ontop of the table
 		shape->asset->setPosition(shape->asset->position * glm::vec3(1.0f, scaleFactor, 1.0f));
 
 		//std::cout << std::endl << "Final Bounds at pos " << glm::to_string(shape->asset->position) << " and a scale factor of " << scaleFactor << std::endl;
-		Unfold::findUnfoldSize(shape);
 	}
 
 	void setupBackBoard() {
@@ -411,6 +769,20 @@ public:
 		return exp(logZoom);
 	}
 
+	// smallest footprint net without overlap (falls back to the best heuristic net for large models or when the search times out)
+	Graph<Face>* exactUnfold(Shape* shape) {
+		int root = shape->adjacency.indexOf(shape->faceMap.rootNode->data);
+		ExactUnfold::Result result = ExactUnfold::solve(shape->adjacency, root);
+
+		if (result.footprint == FLT_MAX) {
+			return Unfold::breadthUnfold(shape);
+		}
+
+		std::cout << std::endl << "Exact unfold for " << shape->name << ": footprint " << result.footprint << (result.optimal ? " (optimal)" : " (best found)") << " after " << result.nodes << " branches" << std::endl;
+
+		return result.tree.toGraph(shape->adjacency);
+	}
+
 	bool setUnfold(Shape* shape, int index) {
 		switch (index) {
 		case 0:
@@ -425,6 +797,12 @@ public:
 		case 3:
 			shape->setUnfold(Unfold::randomBreadthUnfold(shape));
 			break;
+		case 4:
+			shape->setUnfold(Unfold::sourceUnfold(shape));
+			break;
+		case 5:
+			shape->setUnfold(exactUnfold(shape));
+			break;
 		default:
 			return false;
 			break;
@@ -433,6 +811,127 @@ public:
 		return true;
 	}
 
+	// make the face under the mouse the base of the focused shape, or cut/fold the hinge of that face closest to the mouse
+	void pickFace(glm::vec2 screenPos, bool hinge) {
+		if (focusedShape == nullptr) {
+			return;
+		}
+
+		ScenePicker::Hit hit;
+		if (!ui.openGLWidget->pick(screenPos, hit) || hit.asset != focusedShape->asset) {
+			return;
+		}
+
+		FaceAdjacency &adjacency = focusedShape->adjacency;
+		Mesh* mesh = &focusedShape->model->meshes[hit.mesh];
+
+		int face = -1;
+		for (int i = 0; i < adjacency.size() && face == -1; i++) {
+			if (adjacency.faces[i]->mesh == mesh) {
+				face = i;
+			}
+		}
+
+		if (face == -1) {
+			return;
+		}
+
+		if (hinge) {
+			// the meshes are animated in model space, so the hinge is found there
+			glm::vec3 point = glm::vec3(glm::inverse(hit.asset->getModelMatrix()) * glm::vec4(hit.point, 1.0f));
+
+			int neighbor = nearestHinge(focusedShape, face, point);
+			if (neighbor != -1) {
+				toggleHinge(adjacency.faces[face], adjacency.faces[neighbor]);
+			}
+		}
+		else {
+			pickRoot(adjacency.faces[face]);
+		}
+	}
+
+	// unfold the focused shape again from a chosen base
+	void pickRoot(Face* face) {
+		// the search and the hinge editor read the rest pose that setRoot changes
+		stopSearch();
+		clearHingeEditor();
+
+		focusedShape->setRoot(face);
+
+		applyUnfold(focusedShape, false);
+
+		ui.statusBar->showMessage(QString("Base set to face %1").arg(focusedShape->adjacency.indexOf(face)));
+	}
+
+	// the neighbor across the hinge of a face that passes closest to a point (in the current pose of the meshes)
+	int nearestHinge(Shape* shape, int face, glm::vec3 point) {
+		FaceAdjacency &adjacency = shape->adjacency;
+		Mesh* mesh = adjacency.faces[face]->mesh;
+
+		int nearest = -1;
+		float nearestDistance = FLT_MAX;
+
+		for (int i = 0; i < adjacency.edges[face].size(); i++) {
+			const FaceAdjacency::Edge &edge = adjacency.edges[face][i];
+
+			// the ends of the hinge as they are posed right now
+			glm::vec3 start = mesh->getPosedPosition(closestRestVertex(adjacency, face, edge.p1));
+			glm::vec3 end = mesh->getPosedPosition(closestRestVertex(adjacency, face, edge.p2));
+
+			glm::vec3 line = end - start;
+			float along = glm::dot(line, line) > 0 ? glm::clamp(glm::dot(point - start, line) / glm::dot(line, line), 0.0f, 1.0f) : 0.0f;
+			float distance = glm::length(point - (start + line * along));
+
+			if (distance < nearestDistance) {
+				nearestDistance = distance;
+				nearest = edge.neighbor;
+			}
+		}
+
+		return nearest;
+	}
+
+	int closestRestVertex(const FaceAdjacency &adjacency, int face, glm::vec3 pos) {
+		int closest = 0;
+		for (int i = 1; i < adjacency.restPositions[face].size(); i++) {
+			if (glm::length(adjacency.restPositions[face][i] - pos) < glm::length(adjacency.restPositions[face][closest] - pos)) {
+				closest = i;
+			}
+		}
+
+		return closest;
+	}
+
+	// unfold from every face in parallel and keep the base with the least overlap and smallest footprint
+	// the random patterns are scored with their nearest counterpart so the result is repeatable
+	void setBestRootUnfold(Shape* shape, int index) {
+		// the minimal area net is searched from the current base, the root heuristics only score the pattern based nets
+		if (index == 5) {
+			setUnfold(shape, index);
+			return;
+		}
+
+		RootSelection::Pattern pattern = RootSelection::DEPTH_FIRST;
+		if (index == 2 || index == 3) {
+			pattern = RootSelection::BREADTH_FIRST;
+		}
+		else if (index == 4) {
+			pattern = RootSelection::SOURCE;
+		}
+
+		RootSelection::Result best = RootSelection::findBestRoot(shape->adjacency, pattern);
+
+		if (best.root == -1) {
+			setUnfold(shape, index);
+			return;
+		}
+
+		std::cout << std::endl << "Best root for " << shape->name << ": face " << best.root << " (" << best.score.overlaps << " overlaps, footprint " << best.score.footprint << ")" << std::endl;
+
+		shape->setRoot(shape->adjacency.faces[best.root]);
+		shape->setUnfold(best.tree.toGraph(shape->adjacency));
+	}
+
 	void addShapeToList(Shape* shape) {
 		shape->asset->visible = false;
 		ui.listWidget->addItem(shape->name.c_str());
@@ -530,6 +1029,33 @@ private:
 	// viewer pointers
 	Shape* focusedShape;
 
+	// every shape is shown and animated at once (see showGallery)
+	bool galleryMode;
+
+	// background unfold refinement
+	UnfoldSearch search;
+	QTimer* searchTimer;
+	Shape* searchShape;
+	int searchGeneration;
+
+	// incremental cut/fold editing of the focused unfold
+	HingeEditor* hingeEditor;
+	Shape* hingeShape;
+
+	// collision check of the continuous animation running in the background
+	struct CollisionCheck {
+		Shape* shape;
+
+		// the unfold the check is for (see Shape::unfoldRevision) and the status message to add the result to
+		unsigned int revision;
+		QString message;
+
+		std::atomic<bool> cancelled;
+		std::future<ContinuousCollision::Result> result;
+	};
+
+	vector<CollisionCheck*> collisionChecks;
+
 	//Backboard* backboard;
 
 	// camera settings
@@ -580,6 +1106,10 @@ private:
 	Mouse* mouse = nullptr;
 
 	glm::vec2 currentMousePos;
+
+	// where the last button press happened and how far the mouse may move before the release no longer counts as a click
+	glm::vec2 pressPos;
+	const float clickDistance = 4.0f;
 };
 
 #endif
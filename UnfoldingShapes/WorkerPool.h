@@ -0,0 +1,168 @@
+#ifndef WORKERPOOL_H
+#define WORKERPOOL_H
+
+#include <vector>
+#include <deque>
+#include <functional>
+#include <algorithm>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+
+using namespace std;
+
+// A fixed set of threads started once and shared by everything that spreads work over the cores (see UnfoldSchedule).
+// Work is handed in as a batch of numbered tasks, the calling thread takes tasks of its batch too and returns once all of them are done.
+// Idle workers sleep until a batch comes in instead of spinning, and batches from several threads at once are worked through in turn.
+// A batch started from inside a task runs on the calling thread alone, so nested parallel work never waits on the threads it is running on.
+class WorkerPool {
+public:
+	// threadCount of 0 uses every available core (the calling thread counts as one of them)
+	WorkerPool(int threadCount = 0) {
+		if (threadCount <= 0) {
+			threadCount = std::max(1, (int)std::thread::hardware_concurrency());
+		}
+
+		stopping = false;
+
+		for (int t = 1; t < threadCount; t++) {
+			workers.push_back(std::thread(&WorkerPool::work, this));
+		}
+	}
+
+	~WorkerPool() {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stopping = true;
+		}
+		wake.notify_all();
+
+		for (int t = 0; t < workers.size(); t++) {
+			workers[t].join();
+		}
+	}
+
+	// the pool every part of the program shares, started on first use
+	static WorkerPool &shared() {
+		static WorkerPool pool;
+		return pool;
+	}
+
+	// threads that work on a batch (including the calling one)
+	int size() const {
+		return workers.size() + 1;
+	}
+
+	// true on a thread that is running a task of some batch
+	static bool insideTask() {
+		return taskDepth() > 0;
+	}
+
+	// call task(i) for every i from 0 to count - 1 spread over the pool and return once all of them have finished
+	void run(int count, const std::function<void(int)> &task) {
+		if (count <= 0) {
+			return;
+		}
+
+		if (count == 1 || workers.empty() || insideTask()) {
+			taskDepth()++;
+			for (int i = 0; i < count; i++) {
+				task(i);
+			}
+			taskDepth()--;
+
+			return;
+		}
+
+		Batch batch(count, task);
+
+		std::unique_lock<std::mutex> lock(mutex);
+
+		batches.push_back(&batch);
+		wake.notify_all();
+
+		// help with the own batch, then wait for the tasks the workers took
+		while (batch.next < batch.count) {
+			runTask(batch, lock);
+		}
+
+		finished.wait(lock, [&]() {
+			return batch.done == batch.count;
+		});
+
+		// the workers drop a batch once every task is handed out, but may not have got to it yet
+		batches.erase(std::remove(batches.begin(), batches.end(), &batch), batches.end());
+	}
+
+private:
+	struct Batch {
+		int count;
+		const std::function<void(int)> &task;
+
+		// tasks handed out and tasks finished (both guarded by the pool mutex)
+		int next;
+		int done;
+
+		Batch(int count, const std::function<void(int)> &task) : task(task) {
+			this->count = count;
+			next = 0;
+			done = 0;
+		}
+	};
+
+	vector<std::thread> workers;
+
+	// batches that still have tasks to hand out, the oldest first
+	std::deque<Batch*> batches;
+
+	std::mutex mutex;
+	std::condition_variable wake;
+	std::condition_variable finished;
+	bool stopping;
+
+	// tasks the thread is running (a batch started inside one runs serially)
+	static int &taskDepth() {
+		thread_local int depth = 0;
+		return depth;
+	}
+
+	void work() {
+		std::unique_lock<std::mutex> lock(mutex);
+
+		while (true) {
+			while (!batches.empty() && batches.front()->next >= batches.front()->count) {
+				batches.pop_front();
+			}
+
+			if (batches.empty()) {
+				if (stopping) {
+					return;
+				}
+
+				wake.wait(lock);
+				continue;
+			}
+
+			runTask(*batches.front(), lock);
+		}
+	}
+
+	// run the next task of the batch outside of the lock, the lock must be held
+	void runTask(Batch &batch, std::unique_lock<std::mutex> &lock) {
+		int index = batch.next++;
+
+		lock.unlock();
+
+		taskDepth()++;
+		batch.task(index);
+		taskDepth()--;
+
+		lock.lock();
+
+		if (++batch.done == batch.count) {
+			finished.notify_all();
+		}
+	}
+};
+
+#endif
@@ -12,6 +12,12 @@ uniform mat4 model;
 uniform mat4 view;
 uniform mat4 projection;
 
+// rigid transform of the mesh (each face of an unfolding shape is its own mesh)
+uniform mat4 pose = mat4(1.0);
+
+// inverse transpose of the model matrix, worked out once per asset instead of once per vertex
+uniform mat3 normalModel = mat3(1.0);
+
 uniform bool hasHeightTex = false;
 uniform sampler2D texture_height1;
 
@@ -21,15 +27,19 @@ void main()
 {
     TexCoords = aTexCoords;    
 
-    Normal = transpose(inverse(mat3(model))) * aNormal;
+    mat4 world = model * pose;
+
+    // the pose only rotates and moves the face, so it turns the rest normal the same way as the positions
+    Normal = normalModel * (mat3(pose) * aNormal);
 
     vec4 heightTexture = vec4(0.0);
     if (hasHeightTex){
         heightTexture = texture(texture_height1, aTexCoords);
     }
 
-    vec3 position = aPos + Normal * (height_multiplier * (heightTexture.x + heightTexture.y + heightTexture.z) / 3.0);
-    gl_Position = projection * view * model * vec4(position, 1.0);
+    // the height moves the vertex along its rest normal before the pose and model are applied (Normal is already posed)
+    vec3 position = aPos + aNormal * (height_multiplier * (heightTexture.x + heightTexture.y + heightTexture.z) / 3.0);
+    gl_Position = projection * view * world * vec4(position, 1.0);
 
-    FragPos = vec3(model * vec4(position, 1.0));
+    FragPos = vec3(world * vec4(position, 1.0));
 }
\ No newline at end of file